@@ -0,0 +1,148 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Allocator Module Header.
+ *
+ * Definitions for the memory allocator functions, which let bitmaps
+ * and fonts be kept in arenas or pools instead of the heap. Also
+ * includes the allocator structure for internal use only.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __ALLOCATE_H__
+#define __ALLOCATE_H__
+
+/*----------------------------------------------------------------------
+ * Internal Structures.
+ */
+
+/** @struct allocator is an arena or a pool of memory */
+struct allocator {
+
+    /** @var pool is 1 for a pool of blocks, 0 for an arena */
+    int pool;
+
+    /** @var size is the size of the arena, or of each block in a pool */
+    size_t size;
+
+    /** @var count is the number of blocks in a pool */
+    int count;
+
+    /** @var used is the number of bytes used in an arena */
+    size_t used;
+
+    /** @var base is the memory the allocator gives out */
+    char *base;
+
+    /** @var free is the first free block in a pool, or NULL */
+    char *free;
+};
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Create an arena, from which memory is freed all at once.
+ * @param size is the size of the arena in bytes.
+ * @returns the new arena.
+ */
+Allocator *mem_arena (size_t size);
+
+/**
+ * Create a pool of blocks of the same size.
+ * @param size is the size of each block in bytes.
+ * @param count is the number of blocks.
+ * @returns the new pool.
+ */
+Allocator *mem_pool (size_t size, int count);
+
+/**
+ * Allocate memory from an allocator.
+ * @param allocator is the arena or pool, or NULL for the heap.
+ * @param size is the number of bytes needed.
+ * @returns a pointer to the memory, or NULL if there is not enough.
+ */
+void *mem_alloc (Allocator *allocator, size_t size);
+
+/**
+ * Give memory back to the allocator it came from.
+ * @param allocator is the arena or pool, or NULL for the heap.
+ * @param block is the memory to give back.
+ */
+void mem_free (Allocator *allocator, void *block);
+
+/**
+ * Free everything allocated from an arena or pool at once.
+ * @param allocator is the arena or pool.
+ */
+void mem_reset (Allocator *allocator);
+
+/**
+ * Install an allocator for new bitmaps and fonts.
+ * @param allocator is the arena or pool, or NULL for the heap.
+ */
+void mem_install (Allocator *allocator);
+
+/**
+ * Return the allocator installed for new bitmaps and fonts.
+ * @returns the arena or pool, or NULL for the heap.
+ */
+Allocator *mem_installed (void);
+
+/**
+ * Destroy an arena or pool, and everything allocated from it.
+ * @param allocator is the arena or pool.
+ */
+void mem_destroy (Allocator *allocator);
+
+/**
+ * Return the bytes of heap memory held by a class of object.
+ * @param class is the class of object, or MEM_ALL for the total.
+ * @returns the number of bytes.
+ */
+long mem_bytes (MemClass class);
+
+/**
+ * Return the number of live objects of a class.
+ * @param class is the class of object, or MEM_ALL for the total.
+ * @returns the number of objects.
+ */
+int mem_objects (MemClass class);
+
+/**
+ * Return the most heap memory a class of object has held at once.
+ * @param class is the class of object, or MEM_ALL for the total.
+ * @returns the high-water mark in bytes.
+ */
+long mem_peak (MemClass class);
+
+/**
+ * Start the high-water marks again from the memory now held.
+ */
+void mem_clearpeak (void);
+
+/**
+ * Write the memory statistics to an already open file.
+ * @param output is the output file handle.
+ */
+void mem_dump (FILE *output);
+
+/*----------------------------------------------------------------------
+ * Internal Level Function Prototypes.
+ */
+
+#ifdef __CGALIB__
+
+/**
+ * Record memory taken or given back by a class of object.
+ * @param class is the class of object.
+ * @param bytes is the change in heap memory held.
+ * @param objects is the change in the number of objects.
+ */
+void mem_account (MemClass class, long bytes, int objects);
+
+#endif
+
+#endif
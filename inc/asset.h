@@ -0,0 +1,113 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Asset Module Header.
+ *
+ * Definitions for the asset functions, which load the bitmaps in a
+ * file only when they are needed. Also includes the asset structure
+ * for internal use only.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __ASSET_H__
+#define __ASSET_H__
+
+/*----------------------------------------------------------------------
+ * Internal Structures.
+ */
+
+/** @struct assetentry is one bitmap in an asset file */
+struct assetentry {
+
+    /** @var offset is the position of the bitmap in the file */
+    long offset;
+
+    /** @var width is the width of the bitmap in pixels */
+    int width;
+
+    /** @var height is the height of the bitmap in pixels */
+    int height;
+
+    /** @var bitmap is the loaded bitmap, or NULL if not loaded */
+    Bitmap *bitmap;
+
+    /** @var used is the clock reading when the bitmap was last used */
+    unsigned long used;
+};
+
+/** @struct asset is an index of the bitmaps in an open file */
+struct asset {
+
+    /** @var input is the file the bitmaps are loaded from */
+    FILE *input;
+
+    /** @var count is the number of bitmaps in the file */
+    int count;
+
+    /** @var entries is the list of bitmaps in the file */
+    struct assetentry *entries;
+
+    /** @var limit is the most memory for loaded bitmaps, or 0 */
+    long limit;
+
+    /** @var memory is the memory used by loaded bitmaps */
+    long memory;
+
+    /** @var clock counts the uses of bitmaps in the file */
+    unsigned long clock;
+};
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Make an index of the bitmaps in an already open file.
+ * @param input is the input file handle, positioned at a bitmap.
+ * @returns the new asset.
+ */
+Asset *ast_create (FILE *input);
+
+/**
+ * Return the number of bitmaps in an asset file.
+ * @param asset is the asset.
+ * @returns the number of bitmaps.
+ */
+int ast_count (Asset *asset);
+
+/**
+ * Return a bitmap from an asset file, loading it if necessary.
+ * @param asset is the asset.
+ * @param n is the number of the bitmap, counting from 0.
+ * @returns the bitmap, or NULL if it could not be loaded.
+ */
+Bitmap *ast_bitmap (Asset *asset, int n);
+
+/**
+ * Set the most memory the loaded bitmaps of an asset may use.
+ * @param asset is the asset.
+ * @param limit is the limit in bytes, or 0 for no limit.
+ */
+void ast_limit (Asset *asset, long limit);
+
+/**
+ * Return the memory used by the loaded bitmaps of an asset.
+ * @param asset is the asset.
+ * @returns the number of bytes.
+ */
+long ast_memory (Asset *asset);
+
+/**
+ * Unload all the bitmaps of an asset.
+ * @param asset is the asset.
+ */
+void ast_flush (Asset *asset);
+
+/**
+ * Destroy an asset and the bitmaps loaded from it.
+ * @param asset is the asset to destroy.
+ */
+void ast_destroy (Asset *asset);
+
+#endif
@@ -16,6 +16,25 @@
  * Internal Structures.
  */
 
+/** @struct pixelblock is a block of pixels shared by copies */
+struct pixelblock {
+
+    /** @var refs is the number of references to the block */
+    int refs;
+
+    /** @var users is the number of bitmaps using the pixels */
+    int users;
+
+    /** @var block is the memory holding the pixels */
+    void *block;
+
+    /** @var size is the size of the memory in bytes */
+    long size;
+
+    /** @var allocator is where the memory came from, or NULL */
+    Allocator *allocator;
+};
+
 /** @struct bitmap holds the information for a bitmap */
 struct bitmap {
 
@@ -37,6 +56,48 @@ struct bitmap {
     /** @var pixels is a pointer to the pixel data */
     char *pixels;
 
+    /** @var stride is the distance from one row to the next in bytes */
+    int stride;
+
+    /** @var parent is the bitmap viewed, or NULL if pixels are owned */
+    Bitmap *parent;
+
+    /** @var pages is the list of pages of a paged bitmap, or NULL */
+    char **pages;
+
+    /** @var pagerows is the number of rows in each page */
+    int pagerows;
+
+    /** @var allocator is where the bitmap came from, or NULL */
+    Allocator *allocator;
+
+    /** @var shared is the block of pixels shared with copies, or NULL */
+    struct pixelblock *shared;
+
+    /** @var home is the shared block containing this header, or NULL */
+    struct pixelblock *home;
+
+    /** @var views is the number of views of this bitmap */
+    int views;
+
+    /** @var shifts is the pre-shifted pixel data, or NULL */
+    char *shifts;
+
+    /** @var clipx is the x coordinate of the clipping rectangle */
+    int clipx;
+
+    /** @var clipy is the y coordinate of the clipping rectangle */
+    int clipy;
+
+    /** @var clipw is the width of the clipping rectangle */
+    int clipw;
+
+    /** @var cliph is the height of the clipping rectangle */
+    int cliph;
+
+    /** @var region is the clip region, or NULL */
+    ClipRegion *region;
+
 };
 
 /*----------------------------------------------------------------------
@@ -51,6 +112,15 @@ struct bitmap {
  */
 Bitmap *bit_create (int w, int h);
 
+/**
+ * Create a bitmap using a particular allocator.
+ * @param allocator is the arena or pool, or NULL for the heap.
+ * @param width is the width of the bitmap.
+ * @param height is the height of the bitmap.
+ * @returns a new Bitmap.
+ */
+Bitmap *bit_createin (Allocator *allocator, int width, int height);
+
 /**
  * Create a bitmap by copying another.
  * @param src is the bitmap to copy.
@@ -58,6 +128,26 @@ Bitmap *bit_create (int w, int h);
  */
 Bitmap *bit_copy (Bitmap *src);
 
+/**
+ * Create a bitmap that shares part of another bitmap's pixels.
+ * @param parent is the bitmap to view.
+ * @param x is the x coordinate of the view within the parent.
+ * @param y is the y coordinate of the view within the parent.
+ * @param width is the width of the view.
+ * @param height is the height of the view.
+ * @returns a new Bitmap.
+ */
+Bitmap *bit_view (Bitmap *parent, int x, int y, int width, int height);
+
+/**
+ * Create a bitmap whose pixels are kept in separate pages.
+ * @param width is the width of the bitmap.
+ * @param height is the height of the bitmap.
+ * @param rows is the number of rows in each page.
+ * @returns a new Bitmap.
+ */
+Bitmap *bit_createpaged (int width, int height, int rows);
+
 /**
  * Read a bitmap from an already-open file.
  * @param input is the input file handle.
@@ -65,6 +155,7 @@ Bitmap *bit_copy (Bitmap *src);
  */
 Bitmap *bit_read (FILE *input);
 
+
 /**
  * Write a bitmap to an already-open file.
  * @param bitmap is the bitmap to write.
@@ -72,6 +163,13 @@ Bitmap *bit_read (FILE *input);
  */
 void bit_write (Bitmap *bitmap, FILE *output);
 
+/**
+ * Calculate a hash of a bitmap's size and pixels.
+ * @param bitmap is the bitmap to hash.
+ * @returns the hash.
+ */
+unsigned long bit_hash (Bitmap *bitmap);
+
 /**
  * Put part of a bitmap onto another bitmap.
  * @param dst is the bitmap to affect.
@@ -97,6 +195,15 @@ void bit_putpart (Bitmap *dst, Bitmap *src, int xd, int yd,
  */
 void bit_put (Bitmap *dst, Bitmap *src, int x, int y, DrawMode draw);
 
+/**
+ * Put a compiled sprite onto a bitmap.
+ * @param dst is the destination bitmap.
+ * @param src is the compiled sprite.
+ * @param x is the x coordinate on the destination bitmap.
+ * @param y is the y coordinate on the destination bitmap.
+ */
+void bit_putcompiled (Bitmap *dst, Compiled *src, int x, int y);
+
 /**
  * Get one bitmap from another.
  * @param src is the source bitmap.
@@ -106,6 +213,20 @@ void bit_put (Bitmap *dst, Bitmap *src, int x, int y, DrawMode draw);
  */
 void bit_get (Bitmap *src, Bitmap *dst, int x, int y);
 
+/**
+ * Unpack a bitmap into a buffer of one byte per pixel.
+ * @param src is the source bitmap.
+ * @param dst is the destination buffer, width * height bytes long.
+ */
+void bit_unpack (Bitmap *src, char *dst);
+
+/**
+ * Pack a buffer of one byte per pixel into a bitmap.
+ * @param dst is the destination bitmap, whose size is already set.
+ * @param src is the source buffer, width * height bytes long.
+ */
+void bit_pack (Bitmap *dst, char *src);
+
 /**
  * Draw a box onto a Bitmap, filled in the current ink colour.
  * @param bitmap is the destination bitmap.
@@ -118,6 +239,20 @@ void bit_get (Bitmap *src, Bitmap *dst, int x, int y);
  */
 void bit_box (Bitmap *bitmap, int x, int y, int width, int height);
 
+/**
+ * Scroll an area of a bitmap in place.
+ * @param bitmap is the bitmap to affect.
+ * @param x is the x coordinate of the area to scroll.
+ * @param y is the y coordinate of the area to scroll.
+ * @param width is the width of the area to scroll.
+ * @param height is the height of the area to scroll.
+ * @param dx is the distance to move right, or left if negative.
+ * @param dy is the distance to move down, or up if negative.
+ * @param fill is the colour for the exposed area, or -1 to leave it.
+ */
+void bit_scroll (Bitmap *bitmap, int x, int y, int width, int height,
+		 int dx, int dy, int fill);
+
 /**
  * Print some text onto a bitmap in the current ink colour.
  * @param bitmap is the destination bitmap.
@@ -149,10 +284,127 @@ void bit_paper (Bitmap *bitmap, int paper);
  */
 void bit_font (Bitmap *bitmap, Font *font);
 
+/**
+ * Set the clipping rectangle for put and box operations.
+ * @param bitmap is the bitmap to set the clipping rectangle for.
+ * @param x is the x coordinate of the clipping rectangle.
+ * @param y is the y coordinate of the clipping rectangle.
+ * @param width is the width of the clipping rectangle.
+ * @param height is the height of the clipping rectangle.
+ */
+void bit_clip (Bitmap *bitmap, int x, int y, int width, int height);
+
+/**
+ * Attach a clip region to a bitmap.
+ * @param bitmap is the bitmap to attach the region to.
+ * @param region is the clip region, or NULL to remove it.
+ */
+void bit_region (Bitmap *bitmap, ClipRegion *region);
+
+/**
+ * Build the pre-shifted copies used to put a bitmap at any x.
+ * @param bitmap is the bitmap to pre-shift.
+ * @returns 1 on success, 0 if there is not enough memory.
+ */
+int bit_preshift (Bitmap *bitmap);
+
+/**
+ * Set the limit on memory used by pre-shifted copies.
+ * @param limit is the maximum number of bytes to use.
+ */
+void bit_shiftlimit (long limit);
+
+/**
+ * Report the memory used by pre-shifted copies.
+ * @returns the number of bytes in use.
+ */
+long bit_shiftmemory (void);
+
+/**
+ * Make sure a bitmap's pixels are not shared before writing to them.
+ * @param bitmap is the bitmap about to be written to.
+ * @returns 1 on success, 0 if the bitmap is paged or there was not
+ * enough memory.
+ */
+int bit_own (Bitmap *bitmap);
+
 /**
  * Destroy a bitmap.
  * @param bitmap is the bitmap to destroy.
  */
 void bit_destroy (Bitmap *bitmap);
 
+/*----------------------------------------------------------------------
+ * Internal Level Function Prototypes.
+ */
+
+#ifdef __CGALIB__
+
+/**
+ * Put one row of bitmap data in any draw mode.
+ * @param d is the address of the first destination byte.
+ * @param s is the address of the first source byte.
+ * @param n is the number of bytes in the row.
+ * @param draw is the drawing mode to use.
+ */
+void bit_putrow (char far *d, char *s, int n, DrawMode draw);
+
+/**
+ * Put one row of a pre-shifted bitmap.
+ * @param d is the address of the first destination byte.
+ * @param s is the address of the shifted source row.
+ * @param n is the number of bytes in the shifted row.
+ * @param left is the mask of pixels covered in the first byte.
+ * @param right is the mask of pixels covered in the last byte.
+ * @param draw is the drawing mode to use.
+ */
+void bit_shiftrow (char far *d, char *s, int n, char left, char right,
+		   DrawMode draw);
+
+/**
+ * Clip an area to be drawn to a clipping rectangle.
+ * @param xd points to the destination x coordinate.
+ * @param yd points to the destination y coordinate.
+ * @param xs points to the source x coordinate.
+ * @param ys points to the source y coordinate.
+ * @param w points to the width of the area.
+ * @param h points to the height of the area.
+ * @param cx is the x coordinate of the clipping rectangle.
+ * @param cy is the y coordinate of the clipping rectangle.
+ * @param cw is the width of the clipping rectangle.
+ * @param ch is the height of the clipping rectangle.
+ * @returns 1 if any of the area remains to be drawn, 0 if not.
+ */
+int bit_cliprect (int *xd, int *yd, int *xs, int *ys, int *w, int *h,
+		  int cx, int cy, int cw, int ch);
+
+/**
+ * Find the address of a row of a bitmap, which may be paged.
+ * @param bitmap is the bitmap.
+ * @param y is the row.
+ * @returns the address of the first byte of the row.
+ */
+char *bit_row (Bitmap *bitmap, int y);
+
+/**
+ * Describe the page of a paged bitmap that contains a row, as an
+ * ordinary bitmap.
+ * @param paged is the paged bitmap.
+ * @param y is the row.
+ * @param band is the bitmap to fill in with the page's details.
+ * @returns the number of the page's first row in the paged bitmap.
+ */
+int bit_band (Bitmap *paged, int y, Bitmap *band);
+
+/**
+ * Add bytes to a running FNV-1a hash of an image.
+ * @param hash is the hash so far.
+ * @param s is the address of the first byte.
+ * @param n is the number of bytes.
+ * @returns the new hash.
+ */
+unsigned long bit_hashrow (unsigned long hash, char far *s, int n);
+
+#endif
+
 #endif
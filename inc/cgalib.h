@@ -18,6 +18,18 @@
 typedef struct screen Screen;
 typedef struct bitmap Bitmap;
 typedef struct font Font;
+typedef struct compiled Compiled;
+typedef struct clipregion ClipRegion;
+typedef struct viewport Viewport;
+typedef struct allocator Allocator;
+typedef struct asset Asset;
+typedef struct loader Loader;
+typedef struct loadjob LoadJob;
+typedef struct profile Profile;
+typedef struct costmodel CostModel;
+typedef struct sprite Sprite;
+typedef struct spritelayer SpriteLayer;
+typedef struct compositor Compositor;
 
 /* Enum Type Definitions */
 typedef enum {
@@ -27,10 +39,61 @@ typedef enum {
     DRAW_OR,
     DRAW_XOR
 } DrawMode;
+typedef enum {
+    MEM_BITMAP,
+    MEM_FONT,
+    MEM_SCREEN,
+    MEM_CACHE,
+    MEM_ALLOCATOR,
+    MEM_OTHER,
+    MEM_ALL
+} MemClass;
+typedef enum {
+    LDR_PENDING,
+    LDR_DONE,
+    LDR_FAILED
+} LoadStatus;
+typedef enum {
+    PRF_SCR_PUT,
+    PRF_SCR_PUTPART,
+    PRF_SCR_PUTCOMPILED,
+    PRF_SCR_GET,
+    PRF_SCR_BOX,
+    PRF_SCR_SCROLL,
+    PRF_SCR_PRINT,
+    PRF_BIT_PUT,
+    PRF_BIT_PUTPART,
+    PRF_BIT_PUTCOMPILED,
+    PRF_BIT_GET,
+    PRF_BIT_UNPACK,
+    PRF_BIT_PACK,
+    PRF_BIT_BOX,
+    PRF_BIT_SCROLL,
+    PRF_BIT_PRINT,
+    PRF_FNT_PUT,
+    PRF_FNT_GET,
+    PRF_ALL
+} ProfileOp;
+typedef enum {
+    CMP_OPAQUE,
+    CMP_KEYED,
+    CMP_MASKED
+} LayerMode;
 
 /* included headers */
 #include "screen.h"
 #include "bitmap.h"
 #include "font.h"
+#include "import.h"
+#include "compiled.h"
+#include "region.h"
+#include "viewport.h"
+#include "allocate.h"
+#include "asset.h"
+#include "loader.h"
+#include "profile.h"
+#include "record.h"
+#include "sprite.h"
+#include "compose.h"
 
 #endif
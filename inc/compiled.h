@@ -0,0 +1,102 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Compiled Sprite Module Header.
+ *
+ * Definitions for the compiled sprite functions. Also includes the
+ * compiled sprite structures for internal use only.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __COMPILED_H__
+#define __COMPILED_H__
+
+/*----------------------------------------------------------------------
+ * Internal Structures.
+ */
+
+/** @struct compiledrun is a run of bytes in a compiled sprite */
+struct compiledrun {
+
+    /** @var row is the row of the sprite the run is on */
+    int row;
+
+    /** @var offset is the byte offset of the run within the row */
+    int offset;
+
+    /** @var length is the number of bytes in the run */
+    int length;
+
+    /** @var masked is 1 if the bytes are partly transparent */
+    int masked;
+};
+
+/** @struct compiled holds a sprite compiled into runs */
+struct compiled {
+
+    /** @var width is the width of the sprite in pixels */
+    int width;
+
+    /** @var height is the height of the sprite in pixels */
+    int height;
+
+    /** @var count is the number of runs */
+    int count;
+
+    /** @var runs is the list of runs, in row order */
+    struct compiledrun *runs;
+
+    /** @var data is the pixel data, and masks for masked runs */
+    char *data;
+
+    /** @var size is the number of bytes of data */
+    int size;
+
+    /** @var masked is the number of bytes in masked runs */
+    int masked;
+};
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Compile a sprite and its mask into a list of runs.
+ * @param sprite is the sprite bitmap.
+ * @param mask is the mask, colour 3 where the sprite is transparent.
+ * @returns the new compiled sprite.
+ */
+Compiled *cpl_create (Bitmap *sprite, Bitmap *mask);
+
+/**
+ * Destroy a compiled sprite.
+ * @param compiled is the compiled sprite to destroy.
+ */
+void cpl_destroy (Compiled *compiled);
+
+/*----------------------------------------------------------------------
+ * Internal Level Function Prototypes.
+ */
+
+#ifdef __CGALIB__
+
+/**
+ * Put one run of a compiled sprite, clipped to a range of bytes on
+ * its row and to a clip region.
+ * @param run is the run to put.
+ * @param d is the address of the first byte of the destination row.
+ * @param s is the address of the run's data.
+ * @param b is the byte offset of the sprite on the destination row.
+ * @param y is the destination row.
+ * @param a is the first byte that may be drawn.
+ * @param e is the byte after the last that may be drawn.
+ * @param region is the clip region, or NULL for none.
+ * @returns the number of bytes put.
+ */
+int cpl_putrun (struct compiledrun *run, char far *d, char *s, int b,
+		int y, int a, int e, ClipRegion *region);
+
+#endif
+
+#endif
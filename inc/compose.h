@@ -0,0 +1,155 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Compositor Module Header.
+ *
+ * Definitions for the compositor functions, which build a screen area
+ * from a stack of layer bitmaps and present only the cells that have
+ * changed. Also includes the compositor structures for internal use
+ * only.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __COMPOSE_H__
+#define __COMPOSE_H__
+
+/*----------------------------------------------------------------------
+ * Internal Structures.
+ */
+
+/** @var CMP_LAYERS is the most layers a compositor can hold. */
+#define CMP_LAYERS 16
+
+/** @struct complayer is one layer of a compositor */
+struct complayer {
+
+    /** @var image is the bitmap shown in the layer */
+    Bitmap *image;
+
+    /** @var mask is the mask for CMP_MASKED, or NULL */
+    Bitmap *mask;
+
+    /** @var mode is how the layer lets the layers below show through */
+    LayerMode mode;
+
+    /** @var visible is 1 if the layer is shown */
+    int visible;
+
+    /** @var dirty is 1 for each cell changed since the last update */
+    char *dirty;
+
+    /** @var rows is 1 for each row of cells with a changed cell */
+    char *rows;
+
+    /** @var state is whether each cell is empty, partial or opaque */
+    char *state;
+};
+
+/** @struct compositor is a stack of layers shown on the screen */
+struct compositor {
+
+    /** @var screen is the screen the layers are shown on */
+    Screen *screen;
+
+    /** @var x is the x coordinate of the area on the screen */
+    int x;
+
+    /** @var y is the y coordinate of the area on the screen */
+    int y;
+
+    /** @var width is the width of the area */
+    int width;
+
+    /** @var height is the height of the area */
+    int height;
+
+    /** @var cols is the number of cells across the area */
+    int cols;
+
+    /** @var rows is the number of cells down the area */
+    int rows;
+
+    /** @var count is the number of layers */
+    int count;
+
+    /** @var layers are the layers, from the bottom up */
+    struct complayer layers[CMP_LAYERS];
+
+    /** @var draw is the layers to draw in each cell of a row */
+    unsigned int *draw;
+
+    /** @var band is a row of cells in which the layers are combined */
+    Bitmap *band;
+
+    /** @var keymask is a row of cells of mask made for CMP_KEYED */
+    Bitmap *keymask;
+};
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Create a compositor for an area of the screen.
+ * @param screen is the screen to show the layers on.
+ * @param x is the x coordinate of the area on the screen.
+ * @param y is the y coordinate of the area on the screen.
+ * @param width is the width of the area.
+ * @param height is the height of the area.
+ * @returns the new compositor.
+ */
+Compositor *cmp_create (Screen *screen, int x, int y, int width,
+			int height);
+
+/**
+ * Add a layer above the others.
+ * @param compositor is the compositor to add the layer to.
+ * @param image is the bitmap shown in the layer.
+ * @param mask is the mask for CMP_MASKED, or NULL.
+ * @param mode is how the layer lets the layers below show through.
+ * @returns the number of the layer, or -1 on failure.
+ */
+int cmp_addlayer (Compositor *compositor, Bitmap *image, Bitmap *mask,
+		  LayerMode mode);
+
+/**
+ * Mark an area of a layer as changed.
+ * @param compositor is the compositor.
+ * @param layer is the number of the layer.
+ * @param x is the x coordinate of the area.
+ * @param y is the y coordinate of the area.
+ * @param width is the width of the area.
+ * @param height is the height of the area.
+ */
+void cmp_dirty (Compositor *compositor, int layer, int x, int y,
+		int width, int height);
+
+/**
+ * Show or hide a layer.
+ * @param compositor is the compositor.
+ * @param layer is the number of the layer.
+ * @param visible is 1 to show the layer, 0 to hide it.
+ */
+void cmp_show (Compositor *compositor, int layer, int visible);
+
+/**
+ * Mark the whole area to be composed and presented again.
+ * @param compositor is the compositor.
+ */
+void cmp_refresh (Compositor *compositor);
+
+/**
+ * Compose the changed cells and put them on the screen.
+ * @param compositor is the compositor.
+ * @returns the number of cells put on the screen.
+ */
+int cmp_update (Compositor *compositor);
+
+/**
+ * Destroy a compositor. The layer bitmaps are left alone.
+ * @param compositor is the compositor to destroy.
+ */
+void cmp_destroy (Compositor *compositor);
+
+#endif
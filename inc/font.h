@@ -27,6 +27,9 @@ struct font {
 
     /** @var pixels is the pixel data for each character */
     char *pixels;
+
+    /** @var allocator is where the font came from, or NULL */
+    Allocator *allocator;
 };
 
 /*----------------------------------------------------------------------
@@ -41,6 +44,15 @@ struct font {
  */
 Font *fnt_create (int first, int last);
 
+/**
+ * Create a new font using a particular allocator.
+ * @param allocator is the arena or pool, or NULL for the heap.
+ * @param first is the first character in the font.
+ * @param last is the last character in the font.
+ * @returns the new font.
+ */
+Font *fnt_createin (Allocator *allocator, int first, int last);
+
 /**
  * Copy a font.
  * @param font is the font to copy.
@@ -0,0 +1,160 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Game Module Header.
+ *
+ * Definitions for the Droids game played by the demonstration program
+ * and the autoplay benchmark. All of a game's state is kept in a Game
+ * structure, and keys come from an input function supplied by the
+ * program, so that several games can be played at once.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __GAME_H__
+#define __GAME_H__
+
+/*----------------------------------------------------------------------
+ * Type Definitions.
+ */
+
+/* Structure Type Definitions */
+typedef struct game Game;
+
+/* Enum Type Definitions */
+typedef enum {
+    GAME_MOVE,
+    GAME_LEVEL,
+    GAME_AGAIN
+} GamePrompt;
+
+/**
+ * @type GameInput is a function that supplies keys to a game.
+ * @param game is the game asking for a key.
+ * @param prompt is GAME_MOVE for the player's move, GAME_LEVEL at the
+ * end of a level, or GAME_AGAIN to ask whether to play again.
+ * @param data is the data given to game_create ().
+ * @returns the key, or minus the scan code for an extended key.
+ */
+typedef int (*GameInput) (Game *game, GamePrompt prompt, void *data);
+
+/*----------------------------------------------------------------------
+ * Structures.
+ */
+
+/** @struct game is the state of a single game */
+struct game {
+
+    /** @var screen is the screen the game is drawn on */
+    Screen *screen;
+
+    /** @var font is the font for the messages and score */
+    Font *font;
+
+    /** @var bit is the array of 16 bitmaps the game is drawn with */
+    Bitmap **bit;
+
+    /** @var map_img is the persistent map image */
+    Bitmap *map_img;
+
+    /** @var map is the map level as a 2D array */
+    int map[18][10];
+
+    /** @var player_x is the player's X position */
+    int player_x;
+
+    /** @var player_y is the player's Y position */
+    int player_y;
+
+    /** @var droids is the number of droids to generate */
+    int droids;
+
+    /** @var score is the game score */
+    int score;
+
+    /** @var turns is the number of turns played */
+    long turns;
+
+    /** @var seed is the state of the game's random numbers */
+    unsigned int seed;
+
+    /** @var input is the function that supplies the keys */
+    GameInput input;
+
+    /** @var data is passed to the input function */
+    void *data;
+};
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Load and validate a font.
+ * @param filename is the name of the font file.
+ * @returns the loaded font, or NULL on failure.
+ */
+Font *game_loadfont (char *filename);
+
+/**
+ * Load the game's bitmaps.
+ * @param filename is the bitmap file.
+ * @param bit is the array of 16 bitmaps to fill.
+ * @returns 1 if successful, 0 on failure.
+ */
+int game_loadbitmaps (char *filename, Bitmap **bit);
+
+/**
+ * Create a game.
+ * @param screen is the screen to draw the game on.
+ * @param font is the font for the messages and score.
+ * @param bit is the array of 16 bitmaps to draw the game with.
+ * @param seed is the seed for the game's random numbers.
+ * @param input is the function that supplies the keys.
+ * @param data is passed to the input function.
+ * @returns the new game, or NULL if out of memory.
+ */
+Game *game_create (Screen *screen, Font *font, Bitmap **bit,
+		   unsigned int seed, GameInput input, void *data);
+
+/**
+ * Start a new game, drawing the playing field.
+ * @param game is the game.
+ * @returns 1 if successful, 0 if out of memory.
+ */
+int game_start (Game *game);
+
+/**
+ * Set up a single play level.
+ * @param game is the game.
+ */
+void game_level (Game *game);
+
+/**
+ * Play a turn, moving the player and then the droids.
+ * @param game is the game.
+ * @returns 1 if the level is finished, 0 if not.
+ */
+int game_turn (Game *game);
+
+/**
+ * Process the end of a level.
+ * @param game is the game.
+ * @returns 1 if the player is dead, 0 if the level was cleared.
+ */
+int game_endlevel (Game *game);
+
+/**
+ * Process the end of a game.
+ * @param game is the game.
+ * @returns 1 if the player wants to quit, 0 to play again.
+ */
+int game_end (Game *game);
+
+/**
+ * Destroy a game.
+ * @param game is the game.
+ */
+void game_destroy (Game *game);
+
+#endif
@@ -0,0 +1,52 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Import Module Header.
+ *
+ * Definitions for the image import functions, which convert true
+ * colour images into bitmaps in one of the CGA palettes, and back.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __IMPORT_H__
+#define __IMPORT_H__
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Convert rows of true colour pixels into a bitmap.
+ * @param dst is the destination bitmap, whose size is already set.
+ * @param rgb is the row data, 3 bytes per pixel, dst->width wide.
+ * @param y is the first bitmap row to convert.
+ * @param h is the number of rows to convert.
+ * @param palette is the palette number 0..5, or 6 for mode 6.
+ * @param colour is the background colour, 0..15.
+ * @param dither is 1 for ordered dithering, 0 for none.
+ */
+void imp_rows (Bitmap *dst, unsigned char *rgb, int y, int h,
+	       int palette, int colour, int dither);
+
+/**
+ * Read a binary PPM image from an already-open file.
+ * @param input is the input file handle.
+ * @param palette is the palette number 0..5, or 6 for mode 6.
+ * @param colour is the background colour, 0..15.
+ * @param dither is 1 for ordered dithering, 0 for none.
+ * @returns a new Bitmap.
+ */
+Bitmap *imp_ppm (FILE *input, int palette, int colour, int dither);
+
+/**
+ * Write a bitmap to an already-open file as a binary PPM image.
+ * @param src is the bitmap to write.
+ * @param output is the output file handle.
+ * @param palette is the palette number 0..5, or 6 for mode 6.
+ * @param colour is the background colour, 0..15.
+ * @returns 1 on success, 0 on failure.
+ */
+int imp_writeppm (Bitmap *src, FILE *output, int palette, int colour);
+
+#endif
@@ -0,0 +1,161 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Loader Module Header.
+ *
+ * Definitions for the loader functions, which read bitmap and font
+ * files in the background where threads are available. Also includes
+ * the loader structures for internal use only.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __LOADER_H__
+#define __LOADER_H__
+
+#ifdef CGALIB_THREADS
+#include <pthread.h>
+#endif
+
+/*----------------------------------------------------------------------
+ * Internal Structures.
+ */
+
+/** @struct loadjob is a file queued for loading */
+struct loadjob {
+
+    /** @var filename is the name of the file to load */
+    char *filename;
+
+    /** @var allocator is the allocator installed when queued */
+    Allocator *allocator;
+
+    /** @var loader is the loader, until the job is returned */
+    Loader *loader;
+
+    /** @var status is the progress of the job */
+    LoadStatus status;
+
+    /** @var count is the number of bitmaps loaded */
+    int count;
+
+    /** @var bitmaps is the list of bitmaps loaded, or NULL */
+    Bitmap **bitmaps;
+
+    /** @var font is the font loaded, or NULL */
+    Font *font;
+
+    /** @var next is the next job in the same queue */
+    LoadJob *next;
+};
+
+/** @struct loader is a queue of files to load */
+struct loader {
+
+    /** @var threaded is 1 if a worker thread does the loading */
+    int threaded;
+
+    /** @var pending is the first job waiting to be loaded */
+    LoadJob *pending;
+
+    /** @var done is the first job that has been loaded */
+    LoadJob *done;
+
+    /** @var busy is the number of jobs being loaded now */
+    int busy;
+
+#ifdef CGALIB_THREADS
+
+    /** @var quit is 1 when the worker thread should finish */
+    int quit;
+
+    /** @var lock protects the queues */
+    pthread_mutex_t lock;
+
+    /** @var wake is signalled when a job is queued */
+    pthread_cond_t wake;
+
+    /** @var finished is signalled when a job is loaded */
+    pthread_cond_t finished;
+
+    /** @var worker is the worker thread */
+    pthread_t worker;
+
+#endif
+};
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Create a loader.
+ * @param threaded is 1 to load in a worker thread if possible.
+ * @returns the new loader.
+ */
+Loader *ldr_create (int threaded);
+
+/**
+ * Queue a bitmap or font file for loading.
+ * @param loader is the loader.
+ * @param filename is the name of the file.
+ * @returns the job for the file, or NULL if there was no memory.
+ */
+LoadJob *ldr_queue (Loader *loader, char *filename);
+
+/**
+ * Return the next job that has finished loading, without waiting.
+ * @param loader is the loader.
+ * @returns the job, or NULL if none has finished.
+ */
+LoadJob *ldr_poll (Loader *loader);
+
+/**
+ * Return the next job that has finished loading, waiting if need be.
+ * @param loader is the loader.
+ * @returns the job, or NULL if no jobs are left.
+ */
+LoadJob *ldr_wait (Loader *loader);
+
+/**
+ * Return the status of a job.
+ * @param job is the job.
+ * @returns the status.
+ */
+LoadStatus ldr_status (LoadJob *job);
+
+/**
+ * Return the number of bitmaps loaded by a job.
+ * @param job is the job.
+ * @returns the number of bitmaps, or 0 if it has not finished.
+ */
+int ldr_count (LoadJob *job);
+
+/**
+ * Return a bitmap loaded by a job.
+ * @param job is the job.
+ * @param n is the number of the bitmap, counting from 0.
+ * @returns the bitmap, or NULL if n is out of range.
+ */
+Bitmap *ldr_bitmap (LoadJob *job, int n);
+
+/**
+ * Return the font loaded by a job.
+ * @param job is the job.
+ * @returns the font, or NULL if the file held no font.
+ */
+Font *ldr_font (LoadJob *job);
+
+/**
+ * Free a finished job, leaving its bitmaps and font to the program.
+ * @param job is the job.
+ */
+void ldr_release (LoadJob *job);
+
+/**
+ * Destroy a loader, and any jobs not yet returned.
+ * @param loader is the loader to destroy.
+ */
+void ldr_destroy (Loader *loader);
+
+#endif
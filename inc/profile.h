@@ -0,0 +1,193 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Profile Module Header.
+ *
+ * Definitions for the profile functions, which count the drawing done
+ * by the library frame by frame, can record a timeline of it, and can
+ * estimate what it would cost on the machines the library targets. Also
+ * includes the counting hooks for internal use only, which are
+ * compiled in only when the library is built with CGALIB_PROFILE
+ * defined.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+/*----------------------------------------------------------------------
+ * Structures.
+ */
+
+/** @struct profile holds the counts for a function and draw mode */
+struct profile {
+
+    /** @var calls is the number of calls made */
+    long calls;
+
+    /** @var read is the bytes read, from RAM [0] and video RAM [1] */
+    long read[2];
+
+    /** @var written is the bytes written, to RAM [0] and video RAM [1] */
+    long written[2];
+};
+
+/** @struct costmodel holds the costs of drawing on a type of machine */
+struct costmodel {
+
+    /** @var name is the name of the machine */
+    char *name;
+
+    /** @var hz is the processor's clock speed in cycles per second */
+    long hz;
+
+    /** @var call is the cycles taken to call a function and set up */
+    int call;
+
+    /** @var copy is the cycles per byte copied, RAM [0], video RAM [1] */
+    int copy[2];
+
+    /** @var combine is the cycles per byte read, combined and written
+        back in DRAW_AND, DRAW_OR or DRAW_XOR mode */
+    int combine[2];
+};
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Mark the end of a frame, keeping its counts and starting afresh.
+ */
+void prf_frame (void);
+
+/**
+ * Clear all the counts, and the number of frames.
+ */
+void prf_reset (void);
+
+/**
+ * Return the number of frames marked since the counts were cleared.
+ * @returns the number of frames.
+ */
+long prf_frames (void);
+
+/**
+ * Return the counts for the last frame marked.
+ * @param op is the function, or PRF_ALL for all functions.
+ * @param draw is the draw mode, or -1 for all draw modes.
+ * @returns the counts, which are overwritten by the next call.
+ */
+Profile *prf_last (ProfileOp op, int draw);
+
+/**
+ * Return the counts since they were cleared, including this frame.
+ * @param op is the function, or PRF_ALL for all functions.
+ * @param draw is the draw mode, or -1 for all draw modes.
+ * @returns the counts, which are overwritten by the next call.
+ */
+Profile *prf_total (ProfileOp op, int draw);
+
+/**
+ * Write a table of the counts to a file.
+ * @param output is the file to write to.
+ * @param last is 1 for the last frame marked, 0 for the total.
+ */
+void prf_dump (FILE *output, int last);
+
+/**
+ * Start or stop recording a timeline of the drawing functions called.
+ * @param events is the number of calls to keep, or 0 to stop.
+ * @returns 1 if recording has started, 0 if not.
+ */
+int prf_trace (int events);
+
+/**
+ * Return the time taken to record each call on the timeline.
+ * @returns the time in nanoseconds.
+ */
+long prf_overhead (void);
+
+/**
+ * Write the timeline recorded as trace event JSON.
+ * @param output is the file to write to.
+ */
+void prf_writetrace (FILE *output);
+
+/**
+ * Find one of the built-in cost models.
+ * @param name is the name of the machine, such as "8088-cga".
+ * @returns the cost model, or NULL if there is none of that name.
+ */
+CostModel *prf_model (char *name);
+
+/**
+ * Estimate the processor cycles taken by some functions.
+ * @param model is the cost model for the machine.
+ * @param op is the function, or PRF_ALL for all functions.
+ * @param draw is the draw mode, or -1 for all draw modes.
+ * @param last is 1 for the last frame marked, 0 for the total.
+ * @returns the estimated number of cycles.
+ */
+double prf_cycles (CostModel *model, ProfileOp op, int draw, int last);
+
+/**
+ * Write a table of the estimated cycles and time to a file.
+ * @param output is the file to write to.
+ * @param model is the cost model for the machine.
+ * @param last is 1 for the last frame marked, 0 for the total.
+ */
+void prf_dumpcost (FILE *output, CostModel *model, int last);
+
+/*----------------------------------------------------------------------
+ * Internal Level Function Prototypes.
+ */
+
+#ifdef __CGALIB__
+
+#ifdef CGALIB_PROFILE
+
+/**
+ * Count a call to a function, and start its event on the timeline.
+ * @param op is the function.
+ * @param draw is the draw mode.
+ * @param target is the screen, bitmap or font drawn on or taken from.
+ */
+void prf_call (ProfileOp op, DrawMode draw, void *target);
+
+/**
+ * End the event for a call on the timeline.
+ * @param op is the function.
+ */
+void prf_end (ProfileOp op);
+
+/**
+ * Count the bytes read and written on the screen or bitmap drawn on.
+ * @param op is the function.
+ * @param draw is the draw mode.
+ * @param vram is 1 if the screen is the display, 0 if in RAM.
+ * @param read is the number of bytes read.
+ * @param written is the number of bytes written.
+ */
+void prf_bytes (ProfileOp op, DrawMode draw, int vram, long read,
+		long written);
+
+/* the hooks in the drawing functions call the above */
+#define PRF_CALL(op, draw, target) prf_call ((op), (draw), (target))
+#define PRF_END(op) prf_end (op)
+#define PRF_BYTES(op, draw, vram, read, written) \
+    prf_bytes ((op), (draw), (vram), (read), (written))
+
+#else
+
+/* without CGALIB_PROFILE the hooks cost nothing */
+#define PRF_CALL(op, draw, target)
+#define PRF_END(op)
+#define PRF_BYTES(op, draw, vram, read, written) ((void) (op))
+
+#endif
+
+#endif
+
+#endif
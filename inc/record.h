@@ -0,0 +1,201 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Record Module Header.
+ *
+ * Definitions for the record functions, which write the drawing done
+ * by a program to a log file and play it back later. Also includes the
+ * recording hooks for internal use only, which are compiled in only
+ * when the library is built with CGALIB_RECORD defined.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __RECORD_H__
+#define __RECORD_H__
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Start recording the drawing done to a log file.
+ * @param output is the file to write the log to, opened in binary.
+ * @returns 1 if recording has started, 0 if not.
+ */
+int rec_start (FILE *output);
+
+/**
+ * Mark the end of a frame in the log.
+ */
+void rec_frame (void);
+
+/**
+ * Finish the log and stop recording.
+ */
+void rec_stop (void);
+
+/**
+ * Play back a log, drawing everything drawn on the screen onto one.
+ * @param input is the file to read the log from, opened in binary.
+ * @param screen is the screen to draw on.
+ * @returns the number of drawing calls made, or -1 on error.
+ */
+long rec_replay (FILE *input, Screen *screen);
+
+/*----------------------------------------------------------------------
+ * Internal Level Function Prototypes.
+ */
+
+#ifdef __CGALIB__
+
+#ifdef CGALIB_RECORD
+
+/**
+ * Record a call to scr_put or bit_put.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param src is the source bitmap.
+ * @param x is the x coordinate at which the bitmap is to be placed.
+ * @param y is the y coordinate at which the bitmap is to be placed.
+ * @param draw is the draw mode.
+ */
+void rec_put (void *dst, int screen, Bitmap *src, int x, int y,
+	      DrawMode draw);
+
+/**
+ * Record a call to scr_putpart or bit_putpart.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param src is the source bitmap.
+ * @param xd is the x coordinate at which the bitmap is to be placed.
+ * @param yd is the y coordinate at which the bitmap is to be placed.
+ * @param xs is the x coordinate of the source to copy from.
+ * @param ys is the y coordinate of the source to copy from.
+ * @param w is the width of the section to copy.
+ * @param h is the height of the section to copy.
+ * @param draw is the draw mode.
+ */
+void rec_putpart (void *dst, int screen, Bitmap *src, int xd, int yd,
+		  int xs, int ys, int w, int h, DrawMode draw);
+
+/**
+ * Record a call to scr_putcompiled or bit_putcompiled.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param src is the compiled sprite.
+ * @param x is the x coordinate at which the sprite is to be placed.
+ * @param y is the y coordinate at which the sprite is to be placed.
+ */
+void rec_putcompiled (void *dst, int screen, Compiled *src, int x,
+		      int y);
+
+/**
+ * Record a call to scr_get or bit_get.
+ * @param src is the screen or bitmap to take the bitmap from.
+ * @param screen is 1 if src is a screen, 0 if a bitmap.
+ * @param dst is the destination bitmap.
+ * @param x is the x coordinate where the desired pattern lies.
+ * @param y is the y coordinate where the desired pattern lies.
+ */
+void rec_get (void *src, int screen, Bitmap *dst, int x, int y);
+
+/**
+ * Record a call to scr_box or bit_box.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param x is the x coordinate of the top left of the box.
+ * @param y is the y coordinate of the top left of the box.
+ * @param width is the width of the box.
+ * @param height is the height of the box.
+ */
+void rec_box (void *dst, int screen, int x, int y, int width,
+	      int height);
+
+/**
+ * Record a call to scr_scroll or bit_scroll.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param x is the x coordinate of the area to scroll.
+ * @param y is the y coordinate of the area to scroll.
+ * @param width is the width of the area to scroll.
+ * @param height is the height of the area to scroll.
+ * @param dx is the distance to move right, or left if negative.
+ * @param dy is the distance to move down, or up if negative.
+ * @param fill is the colour for the exposed area, or -1 to leave it.
+ */
+void rec_scroll (void *dst, int screen, int x, int y, int width,
+		 int height, int dx, int dy, int fill);
+
+/**
+ * Record a call to scr_print or bit_print.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param x is the x coordinate where the text should appear.
+ * @param y is the y coordinate where the text should appear.
+ * @param message is the message to print.
+ */
+void rec_print (void *dst, int screen, int x, int y, char *message);
+
+/**
+ * Record a call to scr_palette.
+ * @param screen is the screen to affect.
+ * @param palette is the palette number.
+ * @param colour is the background colour.
+ */
+void rec_palette (Screen *screen, int palette, int colour);
+
+/**
+ * Record that a bitmap's pixels have been replaced other than by the
+ * drawing functions.
+ * @param bitmap is the bitmap.
+ */
+void rec_load (Bitmap *bitmap);
+
+/**
+ * Record that a screen or bitmap has been destroyed.
+ * @param target is the screen or bitmap.
+ */
+void rec_destroy (void *target);
+
+/* the hooks in the drawing functions call the above */
+#define REC_PUT(dst, screen, src, x, y, draw) \
+    rec_put ((dst), (screen), (src), (x), (y), (draw))
+#define REC_PUTPART(dst, screen, src, xd, yd, xs, ys, w, h, draw) \
+    rec_putpart ((dst), (screen), (src), (xd), (yd), (xs), (ys), (w), \
+		 (h), (draw))
+#define REC_PUTCOMPILED(dst, screen, src, x, y) \
+    rec_putcompiled ((dst), (screen), (src), (x), (y))
+#define REC_GET(src, screen, dst, x, y) \
+    rec_get ((src), (screen), (dst), (x), (y))
+#define REC_BOX(dst, screen, x, y, width, height) \
+    rec_box ((dst), (screen), (x), (y), (width), (height))
+#define REC_SCROLL(dst, screen, x, y, width, height, dx, dy, fill) \
+    rec_scroll ((dst), (screen), (x), (y), (width), (height), (dx), \
+		(dy), (fill))
+#define REC_PRINT(dst, screen, x, y, message) \
+    rec_print ((dst), (screen), (x), (y), (message))
+#define REC_PALETTE(screen, palette, colour) \
+    rec_palette ((screen), (palette), (colour))
+#define REC_LOAD(bitmap) rec_load (bitmap)
+#define REC_DESTROY(target) rec_destroy (target)
+
+#else
+
+/* without CGALIB_RECORD the hooks cost nothing */
+#define REC_PUT(dst, screen, src, x, y, draw)
+#define REC_PUTPART(dst, screen, src, xd, yd, xs, ys, w, h, draw)
+#define REC_PUTCOMPILED(dst, screen, src, x, y)
+#define REC_GET(src, screen, dst, x, y)
+#define REC_BOX(dst, screen, x, y, width, height)
+#define REC_SCROLL(dst, screen, x, y, width, height, dx, dy, fill)
+#define REC_PRINT(dst, screen, x, y, message)
+#define REC_PALETTE(screen, palette, colour)
+#define REC_LOAD(bitmap)
+#define REC_DESTROY(target)
+
+#endif
+
+#endif
+
+#endif
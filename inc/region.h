@@ -0,0 +1,130 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Clip Region Module Header.
+ *
+ * Definitions for the clip region functions. Also includes the clip
+ * region structures for internal use only.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __REGION_H__
+#define __REGION_H__
+
+/*----------------------------------------------------------------------
+ * Internal Structures.
+ */
+
+/** @struct clipspan is a horizontal span of a clip region */
+struct clipspan {
+
+    /** @var x is the byte offset at which the span starts */
+    int x;
+
+    /** @var w is the width of the span in bytes */
+    int w;
+};
+
+/** @struct cliprow holds the spans for a pair of rows */
+struct cliprow {
+
+    /** @var count is the number of spans */
+    int count;
+
+    /** @var spans is the list of spans, in order from left to right */
+    struct clipspan *spans;
+};
+
+/** @struct clipregion is a region to which drawing is limited */
+struct clipregion {
+
+    /** @var width is the width of the region in pixels */
+    int width;
+
+    /** @var height is the height of the region in pixels */
+    int height;
+
+    /** @var rows is the span list for each pair of rows */
+    struct cliprow *rows;
+};
+
+/*----------------------------------------------------------------------
+ * Internal Level Function Prototypes.
+ */
+
+#ifdef __CGALIB__
+
+/**
+ * Find the next piece of a row that lies within a clip region.
+ * @param region is the clip region, or NULL for no region.
+ * @param y is the row.
+ * @param b is the byte offset of the start of the row to draw.
+ * @param n is the number of bytes in the row to draw.
+ * @param i points to the span counter, initially 0.
+ * @param a points to where the first byte of the piece is stored.
+ * @param e points to where the byte after the piece is stored.
+ * @returns 1 if a piece was found, 0 if there are no more.
+ */
+int rgn_next (ClipRegion *region, int y, int b, int n, int *i,
+	      int *a, int *e);
+
+/**
+ * Put one row of bitmap data through a clip region.
+ * @param region is the clip region.
+ * @param y is the destination row.
+ * @param d is the address of the first destination byte.
+ * @param s is the address of the first source byte.
+ * @param b is the byte offset of the first destination byte.
+ * @param n is the number of bytes in the row.
+ * @param left is the mask of pixels covered in the first byte.
+ * @param right is the mask of pixels covered in the last byte.
+ * @param draw is the drawing mode to use.
+ */
+void rgn_putrow (ClipRegion *region, int y, char far *d, char *s,
+		 int b, int n, char left, char right, DrawMode draw);
+
+#endif
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Create an empty clip region.
+ * @param width is the width of the region in pixels.
+ * @param height is the height of the region in pixels.
+ * @returns the new clip region.
+ */
+ClipRegion *rgn_create (int width, int height);
+
+/**
+ * Add a rectangle to a clip region.
+ * @param region is the clip region to affect.
+ * @param x is the x coordinate of the rectangle.
+ * @param y is the y coordinate of the rectangle.
+ * @param width is the width of the rectangle.
+ * @param height is the height of the rectangle.
+ * @returns 1 on success, 0 if there was not enough memory.
+ */
+int rgn_union (ClipRegion *region, int x, int y, int width, int height);
+
+/**
+ * Remove a rectangle from a clip region.
+ * @param region is the clip region to affect.
+ * @param x is the x coordinate of the rectangle.
+ * @param y is the y coordinate of the rectangle.
+ * @param width is the width of the rectangle.
+ * @param height is the height of the rectangle.
+ * @returns 1 on success, 0 if there was not enough memory.
+ */
+int rgn_subtract (ClipRegion *region, int x, int y, int width,
+		  int height);
+
+/**
+ * Destroy a clip region.
+ * @param region is the clip region to destroy.
+ */
+void rgn_destroy (ClipRegion *region);
+
+#endif
@@ -35,6 +35,27 @@ struct screen {
 
     /** @var font is the current font */
     Font *font;
+
+    /** @var clipx is the x coordinate of the clipping rectangle */
+    int clipx;
+
+    /** @var clipy is the y coordinate of the clipping rectangle */
+    int clipy;
+
+    /** @var clipw is the width of the clipping rectangle */
+    int clipw;
+
+    /** @var cliph is the height of the clipping rectangle */
+    int cliph;
+
+    /** @var region is the clip region, or NULL */
+    ClipRegion *region;
+
+    /** @var memory is the memory drawn in, or NULL for the display */
+    char far *memory;
+
+    /** @var base is the address drawn at, in memory or the display */
+    char far *base;
 };
 
 /*----------------------------------------------------------------------
@@ -48,6 +69,13 @@ struct screen {
  */
 Screen *scr_create (int mode);
 
+/**
+ * Create a screen in ordinary memory, laid out like the display.
+ * @param mode is the screen mode: 4, 5 or 6, or 7 for Hercules.
+ * @returns the new screen.
+ */
+Screen *scr_createmem (int mode);
+
 /**
  * Set the screen palette.
  * @param screen is the screen to affect.
@@ -81,6 +109,15 @@ void scr_putpart (Screen *dst, Bitmap *src, int xd, int yd,
  */
 void scr_put (Screen *dst, Bitmap *src, int x, int y, DrawMode draw);
 
+/**
+ * Put a compiled sprite onto the screen.
+ * @param dst is the screen to affect.
+ * @param src is the compiled sprite.
+ * @param x is the x coordinate at which the sprite is to be placed.
+ * @param y is the y coordinate at which the sprite is to be placed.
+ */
+void scr_putcompiled (Screen *dst, Compiled *src, int x, int y);
+
 /**
  * Get a bitmap from the screen.
  * @param src is the screen from which the bitmap comes.
@@ -102,6 +139,20 @@ void scr_get (Screen *src, Bitmap *dst, int x, int y);
  */
 void scr_box (Screen *screen, int x, int y, int width, int height);
 
+/**
+ * Scroll an area of the screen in place.
+ * @param screen is the screen to affect.
+ * @param x is the x coordinate of the area to scroll.
+ * @param y is the y coordinate of the area to scroll.
+ * @param width is the width of the area to scroll.
+ * @param height is the height of the area to scroll.
+ * @param dx is the distance to move right, or left if negative.
+ * @param dy is the distance to move down, or up if negative.
+ * @param fill is the colour for the exposed area, or -1 to leave it.
+ */
+void scr_scroll (Screen *screen, int x, int y, int width, int height,
+		 int dx, int dy, int fill);
+
 /**
  * Print some text on the screen in the current ink colour.
  * @param screen is the screen to affect.
@@ -133,6 +184,30 @@ void scr_paper (Screen *screen, int paper);
  */
 void scr_font (Screen *screen, Font *font);
 
+/**
+ * Set the clipping rectangle for put and box operations.
+ * @param screen is the screen to affect.
+ * @param x is the x coordinate of the clipping rectangle.
+ * @param y is the y coordinate of the clipping rectangle.
+ * @param width is the width of the clipping rectangle.
+ * @param height is the height of the clipping rectangle.
+ */
+void scr_clip (Screen *screen, int x, int y, int width, int height);
+
+/**
+ * Attach a clip region to the screen.
+ * @param screen is the screen to affect.
+ * @param region is the clip region, or NULL to remove it.
+ */
+void scr_region (Screen *screen, ClipRegion *region);
+
+/**
+ * Calculate a hash of the screen's pixels.
+ * @param screen is the screen to hash.
+ * @returns the hash.
+ */
+unsigned long scr_hash (Screen *screen);
+
 /**
  * Reset the screen back to text mode which graphic output is finished.
  * @param screen is the screen to affect.
@@ -0,0 +1,171 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Sprite Module Header.
+ *
+ * Definitions for the sprite functions, which keep a layer of moving
+ * sprites on the screen over a background that is saved and restored
+ * beneath them. Also includes the sprite structures for internal use
+ * only.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __SPRITE_H__
+#define __SPRITE_H__
+
+/*----------------------------------------------------------------------
+ * Internal Structures.
+ */
+
+/** @struct sprite is a bitmap kept on the screen by a sprite layer */
+struct sprite {
+
+    /** @var layer is the layer the sprite belongs to */
+    SpriteLayer *layer;
+
+    /** @var image is the bitmap drawn */
+    Bitmap *image;
+
+    /** @var mask is the mask put first with DRAW_AND, or NULL */
+    Bitmap *mask;
+
+    /** @var x is the x coordinate of the sprite */
+    int x;
+
+    /** @var y is the y coordinate of the sprite */
+    int y;
+
+    /** @var z is the depth; higher numbers are drawn over lower */
+    int z;
+
+    /** @var visible is 1 if the sprite is to be shown */
+    int visible;
+
+    /** @var changed is 1 if the sprite has changed since drawn */
+    int changed;
+
+    /** @var dead is 1 if the sprite is to be removed and destroyed */
+    int dead;
+
+    /** @var drawn is 1 if the sprite is on the screen */
+    int drawn;
+
+    /** @var order is the order in which the sprite was drawn */
+    int order;
+
+    /** @var rank is the order in which the sprite is to be drawn */
+    int rank;
+
+    /** @var redraw is 1 if the sprite is restored and redrawn */
+    int redraw;
+
+    /** @var under is the background saved from under the sprite */
+    Bitmap *under;
+
+    /** @var ux is the x coordinate of the saved background */
+    int ux;
+
+    /** @var uy is the y coordinate of the saved background */
+    int uy;
+
+    /** @var uw is the width of the saved background */
+    int uw;
+
+    /** @var uh is the height of the saved background */
+    int uh;
+
+    /** @var next is the next sprite up, or NULL */
+    Sprite *next;
+};
+
+/** @struct spritelayer is a list of sprites on a screen */
+struct spritelayer {
+
+    /** @var screen is the screen the sprites are drawn on */
+    Screen *screen;
+
+    /** @var first is the lowest sprite, or NULL */
+    Sprite *first;
+};
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Create a sprite layer on a screen.
+ * @param screen is the screen to draw the sprites on.
+ * @returns the new sprite layer.
+ */
+SpriteLayer *spr_createlayer (Screen *screen);
+
+/**
+ * Create a sprite in a layer. It is not drawn until spr_update ().
+ * @param layer is the layer to add the sprite to.
+ * @param image is the bitmap to draw.
+ * @param mask is the mask to put with DRAW_AND first, or NULL.
+ * @param z is the depth; higher numbers are drawn over lower.
+ * @returns the new sprite.
+ */
+Sprite *spr_create (SpriteLayer *layer, Bitmap *image, Bitmap *mask,
+		    int z);
+
+/**
+ * Move a sprite.
+ * @param sprite is the sprite to move.
+ * @param x is the new x coordinate.
+ * @param y is the new y coordinate.
+ */
+void spr_move (Sprite *sprite, int x, int y);
+
+/**
+ * Change a sprite's image.
+ * @param sprite is the sprite to change.
+ * @param image is the new bitmap to draw.
+ * @param mask is the new mask, or NULL.
+ */
+void spr_image (Sprite *sprite, Bitmap *image, Bitmap *mask);
+
+/**
+ * Change a sprite's depth.
+ * @param sprite is the sprite to change.
+ * @param z is the new depth.
+ */
+void spr_depth (Sprite *sprite, int z);
+
+/**
+ * Show or hide a sprite.
+ * @param sprite is the sprite to change.
+ * @param visible is 1 to show the sprite, 0 to hide it.
+ */
+void spr_show (Sprite *sprite, int visible);
+
+/**
+ * Bring the screen up to date with the changes to a layer's sprites.
+ * @param layer is the layer to update.
+ * @returns the number of sprites redrawn, or -1 if out of memory.
+ */
+int spr_update (SpriteLayer *layer);
+
+/**
+ * Take all of a layer's sprites off the screen, so that the
+ * background can be drawn on. They are redrawn by spr_update ().
+ * @param layer is the layer to erase.
+ */
+void spr_erase (SpriteLayer *layer);
+
+/**
+ * Destroy a sprite. It is taken off the screen by spr_update ().
+ * @param sprite is the sprite to destroy.
+ */
+void spr_destroy (Sprite *sprite);
+
+/**
+ * Destroy a sprite layer, taking its sprites off the screen and
+ * destroying them.
+ * @param layer is the layer to destroy.
+ */
+void spr_destroylayer (SpriteLayer *layer);
+
+#endif
@@ -0,0 +1,93 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Viewport Module Header.
+ *
+ * Definitions for the viewport functions, which show part of a large
+ * world bitmap in a window on the screen. Also includes the viewport
+ * structure for internal use only.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+#ifndef __VIEWPORT_H__
+#define __VIEWPORT_H__
+
+/*----------------------------------------------------------------------
+ * Internal Structures.
+ */
+
+/** @struct viewport is a window on the screen onto a world bitmap */
+struct viewport {
+
+    /** @var screen is the screen the window is on */
+    Screen *screen;
+
+    /** @var world is the bitmap shown through the window */
+    Bitmap *world;
+
+    /** @var x is the x coordinate of the window on the screen */
+    int x;
+
+    /** @var y is the y coordinate of the window on the screen */
+    int y;
+
+    /** @var width is the width of the window */
+    int width;
+
+    /** @var height is the height of the window */
+    int height;
+
+    /** @var wx is the x coordinate of the window's view of the world */
+    int wx;
+
+    /** @var wy is the y coordinate of the window's view of the world */
+    int wy;
+};
+
+/*----------------------------------------------------------------------
+ * Public Level Function Prototypes.
+ */
+
+/**
+ * Create a viewport onto a world bitmap.
+ * @param screen is the screen to show the world on.
+ * @param world is the world bitmap.
+ * @param x is the x coordinate of the window on the screen.
+ * @param y is the y coordinate of the window on the screen.
+ * @param width is the width of the window.
+ * @param height is the height of the window.
+ * @returns the new viewport.
+ */
+Viewport *vpt_create (Screen *screen, Bitmap *world, int x, int y,
+		      int width, int height);
+
+/**
+ * Redraw the whole window from the world bitmap.
+ * @param viewport is the viewport to redraw.
+ */
+void vpt_draw (Viewport *viewport);
+
+/**
+ * Move the view to a new position in the world.
+ * @param viewport is the viewport to affect.
+ * @param wx is the x coordinate of the new view of the world.
+ * @param wy is the y coordinate of the new view of the world.
+ */
+void vpt_moveto (Viewport *viewport, int wx, int wy);
+
+/**
+ * Move the view by a distance across the world.
+ * @param viewport is the viewport to affect.
+ * @param dx is the distance to move right, or left if negative.
+ * @param dy is the distance to move down, or up if negative.
+ */
+void vpt_pan (Viewport *viewport, int dx, int dy);
+
+/**
+ * Destroy a viewport.
+ * @param viewport is the viewport to destroy.
+ */
+void vpt_destroy (Viewport *viewport);
+
+#endif
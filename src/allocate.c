@@ -0,0 +1,354 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Allocator Module.
+ *
+ * Provides arenas, from which memory is freed all at once, and pools of
+ * blocks of a single size. Bitmaps and fonts can be created in either,
+ * with their header and pixels in a single allocation. Also keeps
+ * account of the memory held by each class of object.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include "cgalib.h"
+#ifdef CGALIB_THREADS
+#include <pthread.h>
+#endif
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+#ifdef CGALIB_THREADS
+/** @var lock keeps threads from using allocators at the same time. */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/** @var installed is the allocator for new bitmaps and fonts. */
+static Allocator *installed = NULL;
+
+/** @var held is the heap memory held by each class of object. */
+static long held[MEM_ALL + 1];
+
+/** @var live is the number of live objects of each class. */
+static int live[MEM_ALL + 1];
+
+/** @var peak is the high-water mark of held for each class. */
+static long peak[MEM_ALL + 1];
+
+/** @var names are the names of the classes for mem_dump (). */
+static char *names[MEM_ALL + 1] = {
+    "Bitmaps",
+    "Fonts",
+    "Screens",
+    "Caches",
+    "Allocators",
+    "Other",
+    "Total"
+};
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Round a size up so that the next block is suitably aligned.
+ * @param size is the size to round.
+ * @returns the rounded size.
+ */
+static size_t align (size_t size)
+{
+    return (size + sizeof (long) - 1) / sizeof (long) * sizeof (long);
+}
+
+/*----------------------------------------------------------------------
+ * Internal Level Functions.
+ */
+
+/**
+ * Record memory taken or given back by a class of object.
+ * @param class is the class of object.
+ * @param bytes is the change in heap memory held.
+ * @param objects is the change in the number of objects.
+ */
+void mem_account (MemClass class, long bytes, int objects)
+{
+#ifdef CGALIB_THREADS
+    pthread_mutex_lock (&lock);
+#endif
+    held[class] += bytes;
+    live[class] += objects;
+    if (held[class] > peak[class])
+	peak[class] = held[class];
+    held[MEM_ALL] += bytes;
+    live[MEM_ALL] += objects;
+    if (held[MEM_ALL] > peak[MEM_ALL])
+	peak[MEM_ALL] = held[MEM_ALL];
+#ifdef CGALIB_THREADS
+    pthread_mutex_unlock (&lock);
+#endif
+}
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Create an arena, from which memory is freed all at once.
+ * @param size is the size of the arena in bytes.
+ * @returns the new arena.
+ */
+Allocator *mem_arena (size_t size)
+{
+    /* local variables */
+    Allocator *arena; /* the arena to return */
+
+    /* reserve memory */
+    if (! (arena = malloc (sizeof (Allocator))))
+	return NULL;
+    if (! (arena->base = malloc (size ? size : 1))) {
+	free (arena);
+	return NULL;
+    }
+
+    /* initialise the arena */
+    arena->pool = 0;
+    arena->size = size;
+    arena->count = 0;
+    arena->used = 0;
+    arena->free = NULL;
+    mem_account (MEM_ALLOCATOR, (long) sizeof (Allocator) + size, 1);
+
+    /* return the arena */
+    return arena;
+}
+
+/**
+ * Create a pool of blocks of the same size.
+ * @param size is the size of each block in bytes.
+ * @param count is the number of blocks.
+ * @returns the new pool.
+ */
+Allocator *mem_pool (size_t size, int count)
+{
+    /* local variables */
+    Allocator *pool; /* the pool to return */
+    long total; /* total size of the blocks */
+
+    /* each free block must have room to point to the next */
+    if (size < sizeof (char *))
+	size = sizeof (char *);
+    size = align (size);
+    total = (long) size * count;
+    if (count <= 0 || total != (long) (size_t) total)
+	return NULL;
+
+    /* reserve memory */
+    if (! (pool = malloc (sizeof (Allocator))))
+	return NULL;
+    if (! (pool->base = malloc ((size_t) total))) {
+	free (pool);
+	return NULL;
+    }
+
+    /* initialise the pool with all its blocks free */
+    pool->pool = 1;
+    pool->size = size;
+    pool->count = count;
+    pool->used = 0;
+    mem_reset (pool);
+    mem_account (MEM_ALLOCATOR, sizeof (Allocator) + total, 1);
+
+    /* return the pool */
+    return pool;
+}
+
+/**
+ * Allocate memory from an allocator.
+ * @param allocator is the arena or pool, or NULL for the heap.
+ * @param size is the number of bytes needed.
+ * @returns a pointer to the memory, or NULL if there is not enough.
+ */
+void *mem_alloc (Allocator *allocator, size_t size)
+{
+    /* local variables */
+    char *block; /* the block to return */
+
+    /* without an allocator, use the heap */
+    if (! allocator)
+	return malloc (size ? size : 1);
+
+    /* a pool gives out its first free block, if big enough */
+#ifdef CGALIB_THREADS
+    pthread_mutex_lock (&lock);
+#endif
+    if (allocator->pool) {
+	if (size > allocator->size || ! (block = allocator->free))
+	    block = NULL;
+	else
+	    allocator->free = *(char **) block;
+    }
+
+    /* an arena gives out the next part of its memory */
+    else if ((size = align (size)) > allocator->size - allocator->used)
+	block = NULL;
+    else {
+	block = allocator->base + allocator->used;
+	allocator->used += size;
+    }
+#ifdef CGALIB_THREADS
+    pthread_mutex_unlock (&lock);
+#endif
+    return block;
+}
+
+/**
+ * Give memory back to the allocator it came from.
+ * @param allocator is the arena or pool, or NULL for the heap.
+ * @param block is the memory to give back.
+ */
+void mem_free (Allocator *allocator, void *block)
+{
+    /* heap memory is freed as usual */
+    if (! allocator)
+	free (block);
+
+    /* pool blocks go back on the free list; arena memory is only freed
+       when the arena is reset */
+    else if (allocator->pool) {
+#ifdef CGALIB_THREADS
+	pthread_mutex_lock (&lock);
+#endif
+	*(char **) block = allocator->free;
+	allocator->free = block;
+#ifdef CGALIB_THREADS
+	pthread_mutex_unlock (&lock);
+#endif
+    }
+}
+
+/**
+ * Free everything allocated from an arena or pool at once.
+ * @param allocator is the arena or pool.
+ */
+void mem_reset (Allocator *allocator)
+{
+    /* local variables */
+    int b; /* block counter */
+    char *block; /* current block */
+
+    /* an arena just starts again at the beginning */
+    allocator->used = 0;
+    if (! allocator->pool)
+	return;
+
+    /* a pool links all its blocks into the free list */
+    allocator->free = NULL;
+    for (b = allocator->count - 1; b >= 0; --b) {
+	block = allocator->base + allocator->size * b;
+	*(char **) block = allocator->free;
+	allocator->free = block;
+    }
+}
+
+/**
+ * Install an allocator for new bitmaps and fonts.
+ * @param allocator is the arena or pool, or NULL for the heap.
+ */
+void mem_install (Allocator *allocator)
+{
+    installed = allocator;
+}
+
+/**
+ * Return the allocator installed for new bitmaps and fonts.
+ * @returns the arena or pool, or NULL for the heap.
+ */
+Allocator *mem_installed (void)
+{
+    return installed;
+}
+
+/**
+ * Destroy an arena or pool, and everything allocated from it.
+ * @param allocator is the arena or pool.
+ */
+void mem_destroy (Allocator *allocator)
+{
+    if (allocator) {
+	if (installed == allocator)
+	    installed = NULL;
+	mem_account (MEM_ALLOCATOR, - (long) sizeof (Allocator)
+		     - (long) allocator->size
+		     * (allocator->pool ? allocator->count : 1), -1);
+	free (allocator->base);
+	free (allocator);
+    }
+}
+
+/**
+ * Return the bytes of heap memory held by a class of object.
+ * @param class is the class of object, or MEM_ALL for the total.
+ * @returns the number of bytes.
+ */
+long mem_bytes (MemClass class)
+{
+    return held[class];
+}
+
+/**
+ * Return the number of live objects of a class.
+ * @param class is the class of object, or MEM_ALL for the total.
+ * @returns the number of objects.
+ */
+int mem_objects (MemClass class)
+{
+    return live[class];
+}
+
+/**
+ * Return the most heap memory a class of object has held at once.
+ * @param class is the class of object, or MEM_ALL for the total.
+ * @returns the high-water mark in bytes.
+ */
+long mem_peak (MemClass class)
+{
+    return peak[class];
+}
+
+/**
+ * Start the high-water marks again from the memory now held.
+ */
+void mem_clearpeak (void)
+{
+    /* local variables */
+    int c; /* class counter */
+
+    /* set each mark to the current value */
+    for (c = 0; c <= MEM_ALL; ++c)
+	peak[c] = held[c];
+}
+
+/**
+ * Write the memory statistics to an already open file.
+ * @param output is the output file handle.
+ */
+void mem_dump (FILE *output)
+{
+    /* local variables */
+    int c; /* class counter */
+
+    /* write a line for each class, and one for the total */
+    fprintf (output, "%-10s %7s %10s %10s\n",
+	     "Class", "Objects", "Bytes", "Peak");
+    for (c = 0; c <= MEM_ALL; ++c)
+	fprintf (output, "%-10s %7d %10ld %10ld\n",
+		 names[c], live[c], held[c], peak[c]);
+}
@@ -0,0 +1,239 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Asset Module.
+ *
+ * Keeps an index of the bitmaps in a file, and loads each one only
+ * when it is first used. When memory runs short, the bitmaps that have
+ * gone unused the longest are unloaded to make room.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Scan a file for bitmaps, optionally storing their details.
+ * @param asset is the asset, whose entry list may be NULL.
+ * @param start is the position of the first bitmap in the file.
+ * @returns the number of bitmaps found.
+ */
+static int scan (Asset *asset, long start)
+{
+    /* local variables */
+    struct assetentry *entry; /* current entry */
+    long offset; /* position of the current bitmap */
+    int count; /* bitmaps counted */
+    int w; /* the width read from the file */
+    int h; /* the height read from the file */
+
+    /* read the size of each bitmap and skip over its pixels */
+    count = 0;
+    offset = start;
+    w = h = 0;
+    while (! fseek (asset->input, offset, SEEK_SET)
+	   && fread (&w, 2, 1, asset->input)
+	   && fread (&h, 2, 1, asset->input)) {
+	if (asset->entries) {
+	    entry = asset->entries + count;
+	    entry->offset = offset;
+	    entry->width = w;
+	    entry->height = h;
+	    entry->bitmap = NULL;
+	    entry->used = 0;
+	}
+	++count;
+	offset += 4 + (long) (w / 4) * h;
+    }
+    return count;
+}
+
+/**
+ * Work out the memory a loaded bitmap uses.
+ * @param entry is the entry for the bitmap.
+ * @returns the size in bytes.
+ */
+static long entry_size (struct assetentry *entry)
+{
+    return sizeof (Bitmap) + (long) (entry->width / 4) * entry->height;
+}
+
+/**
+ * Unload the bitmap that has gone unused the longest.
+ * @param asset is the asset.
+ * @param keep is the number of a bitmap not to unload.
+ * @returns 1 if a bitmap was unloaded, 0 if there was none to unload.
+ */
+static int evict (Asset *asset, int keep)
+{
+    /* local variables */
+    struct assetentry *oldest; /* the entry used longest ago */
+    int e; /* entry counter */
+
+    /* find the loaded bitmap used longest ago */
+    oldest = NULL;
+    for (e = 0; e < asset->count; ++e)
+	if (e != keep && asset->entries[e].bitmap
+	    && (! oldest || asset->entries[e].used < oldest->used))
+	    oldest = asset->entries + e;
+
+    /* unload it */
+    if (! oldest)
+	return 0;
+    bit_destroy (oldest->bitmap);
+    oldest->bitmap = NULL;
+    asset->memory -= entry_size (oldest);
+    return 1;
+}
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Make an index of the bitmaps in an already open file.
+ * @param input is the input file handle, positioned at a bitmap.
+ * @returns the new asset.
+ */
+Asset *ast_create (FILE *input)
+{
+    /* local variables */
+    Asset *asset; /* the asset to return */
+    long start; /* position of the first bitmap */
+
+    /* count the bitmaps in the file */
+    if (! (asset = malloc (sizeof (Asset))))
+	return NULL;
+    asset->input = input;
+    asset->entries = NULL;
+    start = ftell (input);
+    asset->count = scan (asset, start);
+
+    /* reserve memory for the index and fill it in */
+    if (! (asset->entries = malloc
+	   ((asset->count ? asset->count : 1)
+	    * sizeof (struct assetentry)))) {
+	free (asset);
+	return NULL;
+    }
+    scan (asset, start);
+
+    /* initialise the rest of the asset */
+    asset->limit = 0;
+    asset->memory = 0;
+    asset->clock = 0;
+    mem_account (MEM_OTHER, sizeof (Asset)
+		 + (long) asset->count * sizeof (struct assetentry), 1);
+
+    /* return the asset */
+    return asset;
+}
+
+/**
+ * Return the number of bitmaps in an asset file.
+ * @param asset is the asset.
+ * @returns the number of bitmaps.
+ */
+int ast_count (Asset *asset)
+{
+    return asset->count;
+}
+
+/**
+ * Return a bitmap from an asset file, loading it if necessary.
+ * @param asset is the asset.
+ * @param n is the number of the bitmap, counting from 0.
+ * @returns the bitmap, or NULL if it could not be loaded.
+ */
+Bitmap *ast_bitmap (Asset *asset, int n)
+{
+    /* local variables */
+    struct assetentry *entry; /* the entry for the bitmap */
+    Bitmap *bitmap; /* the loaded bitmap */
+
+    /* note the use of the bitmap, returning it if already loaded */
+    if (n < 0 || n >= asset->count)
+	return NULL;
+    entry = asset->entries + n;
+    entry->used = ++asset->clock;
+    if (entry->bitmap)
+	return entry->bitmap;
+
+    /* make room within the limit, and within the memory available */
+    while (asset->limit
+	   && asset->memory + entry_size (entry) > asset->limit
+	   && evict (asset, n));
+    while (! (bitmap = bit_create (entry->width, entry->height))
+	   && evict (asset, n));
+    if (! bitmap)
+	return NULL;
+
+    /* load the pixels */
+    if (fseek (asset->input, entry->offset + 4, SEEK_SET)
+	|| ! fread (bitmap->pixels, (size_t) (entry->width / 4)
+		    * entry->height, 1, asset->input)) {
+	bit_destroy (bitmap);
+	return NULL;
+    }
+
+    /* keep and return the bitmap */
+    REC_LOAD (bitmap);
+    entry->bitmap = bitmap;
+    asset->memory += entry_size (entry);
+    return bitmap;
+}
+
+/**
+ * Set the most memory the loaded bitmaps of an asset may use.
+ * @param asset is the asset.
+ * @param limit is the limit in bytes, or 0 for no limit.
+ */
+void ast_limit (Asset *asset, long limit)
+{
+    asset->limit = limit;
+    while (limit && asset->memory > limit && evict (asset, -1));
+}
+
+/**
+ * Return the memory used by the loaded bitmaps of an asset.
+ * @param asset is the asset.
+ * @returns the number of bytes.
+ */
+long ast_memory (Asset *asset)
+{
+    return asset->memory;
+}
+
+/**
+ * Unload all the bitmaps of an asset.
+ * @param asset is the asset.
+ */
+void ast_flush (Asset *asset)
+{
+    while (evict (asset, -1));
+}
+
+/**
+ * Destroy an asset and the bitmaps loaded from it.
+ * @param asset is the asset to destroy.
+ */
+void ast_destroy (Asset *asset)
+{
+    if (asset) {
+	ast_flush (asset);
+	mem_account (MEM_OTHER, - (long) sizeof (Asset)
+		     - (long) asset->count * sizeof (struct assetentry), -1);
+	free (asset->entries);
+	free (asset);
+    }
+}
@@ -0,0 +1,416 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Autoplay Benchmark.
+ *
+ * Plays a large number of games of Droids, each with its own seed,
+ * with the keys chosen by a simple player that avoids the droids. The
+ * games are drawn on screens in memory, and with CGALIB_THREADS are
+ * shared between threads so as to keep every processor busy. Reports
+ * the turns played per second and the bytes drawn on the screen per
+ * turn, as a measure of the library's speed in a real game.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* the wall clock used with threads is POSIX, like the threads */
+#ifdef CGALIB_THREADS
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* system headers for threads */
+#ifdef CGALIB_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/* project headers */
+#include "cgalib.h"
+#include "game.h"
+
+/*----------------------------------------------------------------------
+ * File Level Variables.
+ */
+
+/** @var MAX_THREADS is the most threads that can be used. */
+#define MAX_THREADS 64
+
+/** @var SAMPLE is the number of games replayed to count the bytes. */
+#define SAMPLE 16
+
+/** @struct worker is a thread playing games, and its results */
+typedef struct {
+
+    /** @var screen is the screen in memory the games are drawn on */
+    Screen *screen;
+
+#ifdef CGALIB_THREADS
+    /** @var thread is the thread itself */
+    pthread_t thread;
+#endif
+
+    /** @var games is the number of games played */
+    long games;
+
+    /** @var turns is the number of turns played */
+    long turns;
+
+    /** @var score is the total of the scores */
+    long score;
+
+    /** @var hash is the total of the hashes of the final screens */
+    unsigned long hash;
+
+    /** @var failed is 1 if a game could not be played */
+    int failed;
+} Worker;
+
+/** @var fnt is the game font. */
+static Font *fnt;
+
+/** @var bit is the array of game bitmaps. */
+static Bitmap *bit[16];
+
+/** @var mode is the screen mode of the screens in memory. */
+static int mode;
+
+/** @var first is the seed of the first game. */
+static unsigned int first;
+
+/** @var games is the number of games to play. */
+static long games;
+
+/** @var limit is the most turns a game may last. */
+static long limit;
+
+/** @var next is the number of the next game to play. */
+static long next;
+
+#ifdef CGALIB_THREADS
+/** @var lock protects the next game number. */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/** @var workers are the threads and their results. */
+static Worker workers[MAX_THREADS];
+
+/*----------------------------------------------------------------------
+ * Service Routines.
+ */
+
+/**
+ * Error Handler.
+ * @param errorlevel is the error level to return to the OS.
+ * @param message is the message to print.
+ */
+void error_handler (int errorlevel, char *message)
+{
+    puts (message);
+    exit (errorlevel);
+}
+
+/*----------------------------------------------------------------------
+ * Level 3 Routines.
+ */
+
+/**
+ * Count the droids that would step on to a square next turn.
+ * @param game is the game.
+ * @param x is the x coordinate of the square.
+ * @param y is the y coordinate of the square.
+ * @returns the number of droids next to the square.
+ */
+static int danger (Game *game, int x, int y)
+{
+    /* local variables */
+    int dx, dy; /* offsets to the neighbouring squares */
+    int count; /* number of droids found */
+
+    count = 0;
+    for (dx = -1; dx <= 1; ++dx)
+	for (dy = -1; dy <= 1; ++dy)
+	    if (x + dx >= 0 && x + dx <= 17 && y + dy >= 0 && y + dy <= 9
+		&& game->map[x + dx][y + dy] == 3)
+		++count;
+    return count;
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Routines.
+ */
+
+/**
+ * Choose the keys for a game, as a player avoiding the droids would.
+ * @param game is the game asking for a key.
+ * @param prompt is what the key is wanted for.
+ * @param data is unused.
+ * @returns the key chosen.
+ */
+static int choose_key (Game *game, GamePrompt prompt, void *data)
+{
+    /* local variables */
+    static char *keys = "578946123"; /* keys for each direction */
+    static int dx[9] = {0, -1, 0, 1, -1, 1, -1, 0, 1}; /* x offsets */
+    static int dy[9] = {0, -1, -1, -1, 0, 0, 1, 1, 1}; /* y offsets */
+    int x, y; /* square to move to */
+    int d; /* direction counter */
+    int start; /* direction to try first */
+
+    /* answer the prompts at the end of a level or game */
+    if (prompt == GAME_LEVEL)
+	return ' ';
+    else if (prompt == GAME_AGAIN)
+	return 'n';
+
+    /* try each move, starting somewhere that varies from turn to turn */
+    start = (int) (game->turns % 9);
+    for (d = 0; d < 9; ++d) {
+	x = game->player_x + dx[(start + d) % 9];
+	y = game->player_y + dy[(start + d) % 9];
+	if (x >= 0 && x <= 17 && y >= 0 && y <= 9
+	    && (game->map[x][y] == 0 || game->map[x][y] == 1)
+	    && ! danger (game, x, y))
+	    return keys[(start + d) % 9];
+    }
+
+    /* teleport if there's no safe move */
+    return ' ';
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Play one game through to the end, or to the turn limit.
+ * @param screen is the screen to play it on.
+ * @param seed is the seed for the game.
+ * @param worker is where to add the results.
+ * @returns 1 if the game was played, 0 if out of memory.
+ */
+static int play_game (Screen *screen, unsigned int seed, Worker *worker)
+{
+    /* local variables */
+    Game *game; /* the game being played */
+    int dead; /* 1 if the player is dead */
+    int finished; /* 1 if the level is finished */
+
+    /* clear the screen and start the game */
+    scr_ink (screen, 0);
+    scr_box (screen, 0, 0, 320, 200);
+    scr_ink (screen, 3);
+    if (! (game = game_create (screen, fnt, bit, seed, choose_key, NULL)))
+	return 0;
+    if (! game_start (game)) {
+	game_destroy (game);
+	return 0;
+    }
+
+    /* play levels until the player dies or the turns run out */
+    dead = 0;
+    while (! dead && game->turns < limit) {
+	game_level (game);
+	do {
+	    finished = game_turn (game);
+	} while (! finished && game->turns < limit);
+	dead = game_endlevel (game);
+    }
+    game_end (game);
+
+    /* add up the results */
+    ++worker->games;
+    worker->turns += game->turns;
+    worker->score += game->score;
+    worker->hash += scr_hash (screen);
+    game_destroy (game);
+    return 1;
+}
+
+/**
+ * Play games until there are none left.
+ * @param data is the worker playing them.
+ * @returns NULL.
+ */
+static void *work (void *data)
+{
+    /* local variables */
+    Worker *worker; /* the worker */
+    long g; /* the number of the game to play */
+
+    worker = data;
+    for (;;) {
+
+	/* take the next game */
+#ifdef CGALIB_THREADS
+	pthread_mutex_lock (&lock);
+#endif
+	g = next++;
+#ifdef CGALIB_THREADS
+	pthread_mutex_unlock (&lock);
+#endif
+	if (g >= games)
+	    break;
+
+	/* play it */
+	if (! play_game (worker->screen, first + (unsigned int) g,
+			 worker)) {
+	    worker->failed = 1;
+	    break;
+	}
+    }
+    return NULL;
+}
+
+/**
+ * Read the clock for timing.
+ * @returns the time in seconds from some fixed point.
+ */
+static double now (void)
+{
+#ifdef CGALIB_THREADS
+    /* local variables */
+    struct timespec ts; /* the time from the monotonic clock */
+
+    /* clock () adds up the time of all threads, so use the wall clock */
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+    return (double) clock () / CLOCKS_PER_SEC;
+#endif
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main program.
+ * @param argc is the number of command line arguments.
+ * @param argv is the command line arguments.
+ * No return value as exit () is used to terminate abnormally.
+ */
+void main (int argc, char **argv)
+{
+    /* local variables */
+    Worker sample; /* results of the sample replayed for counting */
+    Profile *p; /* profile counts for one function */
+    int threads; /* the number of threads to use */
+    int t; /* thread counter */
+    int c; /* argument counter */
+    long turns; /* total turns played */
+    long score; /* total score */
+    long read; /* bytes read from the screen in the sample */
+    long written; /* bytes written to the screen in the sample */
+    unsigned long hash; /* total of the final screen hashes */
+    double start; /* clock reading at the start */
+    double seconds; /* seconds taken */
+
+    /* read the options */
+    games = 1000;
+    limit = 1000;
+    first = 1;
+    mode = 4;
+#ifdef CGALIB_THREADS
+    threads = (int) sysconf (_SC_NPROCESSORS_ONLN);
+#else
+    threads = 1;
+#endif
+    for (c = 1; c < argc; ++c)
+	if (! strcmp (argv[c], "-g") && c + 1 < argc)
+	    games = atol (argv[++c]);
+	else if (! strcmp (argv[c], "-t") && c + 1 < argc)
+	    limit = atol (argv[++c]);
+	else if (! strcmp (argv[c], "-s") && c + 1 < argc)
+	    first = (unsigned int) atol (argv[++c]);
+	else if (! strcmp (argv[c], "-j") && c + 1 < argc)
+	    threads = atoi (argv[++c]);
+	else if (! strcmp (argv[c], "-h"))
+	    mode = 7;
+	else
+	    games = 0;
+    if (games < 1 || limit < 1)
+	error_handler (1, "Usage: autoplay [-g games] [-t turns] "
+		       "[-s seed] [-j threads] [-h]");
+#ifndef CGALIB_THREADS
+    threads = 1;
+#endif
+    if (threads < 1)
+	threads = 1;
+    else if (threads > MAX_THREADS)
+	threads = MAX_THREADS;
+
+    /* load the font and bitmaps, and create a screen for each thread */
+    if (! (fnt = game_loadfont ("fnt/future.fnt")))
+	error_handler (1, "Cannot load font");
+    if (! game_loadbitmaps ("bit/demo.bit", bit))
+	error_handler (1, "Cannot load bitmaps");
+    for (t = 0; t < threads; ++t)
+	if (! (workers[t].screen = scr_createmem (mode)))
+	    error_handler (1, "Cannot create the screens");
+
+    /* play the games, sharing them between the threads */
+    next = 0;
+    start = now ();
+#ifdef CGALIB_THREADS
+    for (t = 1; t < threads; ++t)
+	if (pthread_create (&workers[t].thread, NULL, work, &workers[t]))
+	    error_handler (1, "Cannot start the threads");
+#endif
+    work (&workers[0]);
+#ifdef CGALIB_THREADS
+    for (t = 1; t < threads; ++t)
+	pthread_join (workers[t].thread, NULL);
+#endif
+    seconds = now () - start;
+
+    /* add up the results */
+    turns = score = 0;
+    hash = 0;
+    for (t = 0; t < threads; ++t) {
+	if (workers[t].failed)
+	    error_handler (1, "Out of memory playing the games");
+	turns += workers[t].turns;
+	score += workers[t].score;
+	hash += workers[t].hash;
+    }
+
+    /* the profile counts are not kept per thread, so replay a sample */
+    prf_reset ();
+    memset (&sample, 0, sizeof (Worker));
+    for (c = 0; c < SAMPLE && c < games; ++c)
+	if (! play_game (workers[0].screen, first + (unsigned int) c,
+			 &sample))
+	    error_handler (1, "Out of memory playing the games");
+    read = written = 0;
+    for (c = PRF_SCR_PUT; c <= PRF_SCR_PRINT; ++c) {
+	p = prf_total ((ProfileOp) c, -1);
+	read += p->read[0] + p->read[1];
+	written += p->written[0] + p->written[1];
+    }
+    for (t = 0; t < threads; ++t)
+	scr_destroy (workers[t].screen);
+
+    /* report the results */
+    printf ("%ld games, %ld turns in %.2f seconds on %d thread%s",
+	    games, turns, seconds, threads, threads == 1 ? "" : "s");
+    if (seconds > 0)
+	printf (", %.0f turns per second", turns / seconds);
+    printf ("\nTotal score %ld, screen check %08lx\n", score,
+	    hash & 0xffffffffUL);
+    if (written)
+	printf ("Screen bytes per turn %.0f written, %.0f read\n",
+		(double) written / sample.turns,
+		(double) read / sample.turns);
+    else
+	puts ("Build the library with PROFILE=1 to count the screen bytes");
+}
@@ -0,0 +1,555 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Benchmark Program.
+ *
+ * Times the blitting, filling and printing functions of the Bitmap
+ * and Screen modules over a range of draw modes, sizes, alignments and
+ * colours, and a frame of moving sprites drawn through a sprite layer
+ * and a compositor against the same frame redrawn in full. The Screen
+ * functions are timed on a screen in memory, so the display is left
+ * alone. Results are written as comma-separated values, one line per
+ * case, to be compared between versions.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* project headers */
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * File Level Variables.
+ */
+
+/** @var REPEATS is the number of timed repeats of each case. */
+#define REPEATS 5
+
+/** @var WARMUP is the number of untimed calls before each case. */
+#define WARMUP 2
+
+/** @var FRAME_SPRITES is the number of sprites moved in a frame. */
+#define FRAME_SPRITES 8
+
+/** @var SIZES is the number of bitmap sizes tried. */
+#define SIZES 6
+
+/** @var sizes are the widths and heights of the bitmaps tried. */
+static int sizes[SIZES][2] = {
+    {8, 8}, {16, 16}, {32, 32}, {64, 64}, {160, 100}, {320, 200}
+};
+
+/** @var lengths are the message lengths tried for printing. */
+static int lengths[3] = {1, 10, 40};
+
+/** @var colours are the ink and paper combinations for printing. */
+static int colours[3][2] = {{3, 0}, {1, 2}, {0, 3}};
+
+/** @var modes are the names of the draw modes. */
+static char *modes[5] = {"pset", "preset", "and", "or", "xor"};
+
+/** @var scr is the screen in memory. */
+static Screen *scr;
+
+/** @var canvas is a full-screen bitmap drawn on or taken from. */
+static Bitmap *canvas;
+
+/** @var sprite is the bitmap put or got in the current case. */
+static Bitmap *sprite;
+
+/** @var message is the message printed in the current case. */
+static char message[81];
+
+/** @var filter is the only operation to time, or NULL for all. */
+static char *filter;
+
+/** @var target is the fewest clock ticks a timed repeat may take. */
+static clock_t target;
+
+/** @var x is the x coordinate for the current case. */
+static int x;
+
+/** @var y is the y coordinate for the current case. */
+static int y;
+
+/** @var draw is the draw mode for the current case. */
+static DrawMode draw;
+
+/** @var mask is the mask of the sprite in the frame cases. */
+static Bitmap *mask;
+
+/** @var layer is the sprite layer in the frame cases. */
+static SpriteLayer *layer;
+
+/** @var sprites are the sprites moved in the frame cases. */
+static Sprite *sprites[FRAME_SPRITES];
+
+/** @var frame is the number of the frame being drawn. */
+static int frame;
+
+/** @var drawn is the number of sprites drawn by the last update. */
+static int drawn;
+
+/** @var overlay is the compositor's layer the sprites are put on. */
+static Bitmap *overlay;
+
+/** @var compositor is the compositor in the frame cases. */
+static Compositor *compositor;
+
+/** @var cells is the number of cells put by the last update. */
+static int cells;
+
+/*----------------------------------------------------------------------
+ * Service Routines.
+ */
+
+/**
+ * Error Handler.
+ * @param errorlevel is the error level to return to the OS.
+ * @param message is the message to print.
+ */
+void error_handler (int errorlevel, char *message)
+{
+    puts (message);
+    exit (errorlevel);
+}
+
+/*----------------------------------------------------------------------
+ * Level 3 Routines.
+ */
+
+/**
+ * Work out where a sprite is in the current frame.
+ * @param s is the number of the sprite.
+ * @param sx is set to the x coordinate.
+ * @param sy is set to the y coordinate.
+ * Each sprite moves a byte to the right each frame, on its own row.
+ */
+static void place (int s, int *sx, int *sy)
+{
+    *sx = (4 * frame + 40 * s) % 304;
+    *sy = 8 + 24 * s;
+}
+
+/**
+ * Move the sprites on the compositor's overlay to the next frame,
+ * marking where each one was and where it is now.
+ */
+static void move_overlay (void)
+{
+    /* local variables */
+    int s; /* sprite counter */
+
+    /* take each sprite off, then put it on in its new place */
+    bit_ink (overlay, 0);
+    for (s = 0; s < FRAME_SPRITES; ++s) {
+	place (s, &x, &y);
+	bit_box (overlay, x, y, sprite->width, sprite->height);
+	cmp_dirty (compositor, 1, x, y, sprite->width, sprite->height);
+    }
+    ++frame;
+    for (s = 0; s < FRAME_SPRITES; ++s) {
+	place (s, &x, &y);
+	bit_put (overlay, sprite, x, y, DRAW_PSET);
+	cmp_dirty (compositor, 1, x, y, sprite->width, sprite->height);
+    }
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Routines.
+ */
+
+/* The operations timed, using the settings for the current case */
+
+static void op_bit_put (void)
+{
+    bit_put (canvas, sprite, x, y, draw);
+}
+
+static void op_bit_putpart (void)
+{
+    bit_putpart (canvas, sprite, x, y, 0, 0, sprite->width,
+		 sprite->height / 2, draw);
+}
+
+static void op_bit_get (void)
+{
+    bit_get (canvas, sprite, x, y);
+}
+
+static void op_bit_box (void)
+{
+    bit_box (canvas, x, y, sprite->width, sprite->height);
+}
+
+static void op_bit_print (void)
+{
+    bit_print (canvas, x, y, message);
+}
+
+static void op_scr_put (void)
+{
+    scr_put (scr, sprite, x, y, draw);
+}
+
+static void op_scr_putpart (void)
+{
+    scr_putpart (scr, sprite, x, y, 0, 0, sprite->width,
+		 sprite->height / 2, draw);
+}
+
+static void op_scr_get (void)
+{
+    scr_get (scr, sprite, x, y);
+}
+
+static void op_scr_box (void)
+{
+    scr_box (scr, x, y, sprite->width, sprite->height);
+}
+
+static void op_scr_print (void)
+{
+    scr_print (scr, x, y, message);
+}
+
+static void op_spr_update (void)
+{
+    /* local variables */
+    int s; /* sprite counter */
+
+    /* move every sprite, and let the layer redraw them */
+    ++frame;
+    for (s = 0; s < FRAME_SPRITES; ++s) {
+	place (s, &x, &y);
+	spr_move (sprites[s], x, y);
+    }
+    drawn = spr_update (layer);
+}
+
+static void op_spr_redraw (void)
+{
+    /* local variables */
+    int s; /* sprite counter */
+
+    /* put the background, then every sprite where it is now */
+    ++frame;
+    scr_put (scr, canvas, 0, 0, DRAW_PSET);
+    for (s = 0; s < FRAME_SPRITES; ++s) {
+	place (s, &x, &y);
+	scr_put (scr, mask, x, y, DRAW_AND);
+	scr_put (scr, sprite, x, y, DRAW_OR);
+    }
+}
+
+static void op_cmp_update (void)
+{
+    move_overlay ();
+    cells = cmp_update (compositor);
+}
+
+static void op_cmp_redraw (void)
+{
+    move_overlay ();
+    cmp_refresh (compositor);
+    cells = cmp_update (compositor);
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Compare two timings for sorting.
+ * @param a is the first timing.
+ * @param b is the second timing.
+ * @returns -1, 0 or 1 as a is less than, equal to or more than b.
+ */
+static int compare (const void *a, const void *b)
+{
+    if (*(double *) a < *(double *) b)
+	return -1;
+    return *(double *) a > *(double *) b;
+}
+
+/**
+ * Time an operation and write a line of results.
+ * @param name is the name of the operation.
+ * @param op is the operation.
+ * @param mode is the name of the draw mode, or "-".
+ * @param align is the alignment tried.
+ * @param ink is the ink colour, or -1.
+ * @param paper is the paper colour, or -1.
+ * @param bytes is the number of bytes each operation draws or copies.
+ */
+static void measure (char *name, void (*op) (void), char *mode,
+		     int align, int ink, int paper, long bytes)
+{
+    /* local variables */
+    double ns[REPEATS]; /* nanoseconds per operation in each repeat */
+    long count; /* number of operations in each repeat */
+    long c; /* operation counter */
+    int r; /* repeat counter */
+    clock_t start; /* clock reading at the start */
+    clock_t elapsed; /* clock ticks taken */
+
+    /* skip operations not asked for */
+    if (filter && strcmp (filter, name))
+	return;
+
+    /* warm up, then find how many calls fill the target time */
+    for (c = 0; c < WARMUP; ++c)
+	op ();
+    for (count = 1; ; count *= 2) {
+	start = clock ();
+	for (c = 0; c < count; ++c)
+	    op ();
+	if ((elapsed = clock () - start) >= target)
+	    break;
+    }
+
+    /* time each repeat */
+    for (r = 0; r < REPEATS; ++r) {
+	start = clock ();
+	for (c = 0; c < count; ++c)
+	    op ();
+	elapsed = clock () - start;
+	ns[r] = 1e9 * elapsed / CLOCKS_PER_SEC / count;
+    }
+    qsort (ns, REPEATS, sizeof (double), compare);
+
+    /* write the results */
+    printf ("%s,%s,%d,%d,%d,%d,%d,%ld,%.0f,%.0f,%.0f,%.0f,%ld\n",
+	    name, mode, sprite->width, sprite->height, align, ink, paper,
+	    count, ns[0], ns[REPEATS / 2], ns[REPEATS - 1],
+	    ns[REPEATS / 2] ? bytes * 1e9 / ns[REPEATS / 2] : 0.0, bytes);
+}
+
+/**
+ * Time the put operations for one size of bitmap.
+ * @param w is the width of the bitmap.
+ * @param h is the height of the bitmap.
+ */
+static void time_puts (int w, int h)
+{
+    /* local variables */
+    int m; /* draw mode counter */
+    int align; /* alignment counter */
+
+    /* create a patterned sprite, pre-shifted if possible */
+    sprite = bit_create (w, h);
+    bit_ink (sprite, 1);
+    bit_box (sprite, 0, 0, w, h);
+    bit_ink (sprite, 2);
+    bit_box (sprite, 0, 0, w / 2, h / 2);
+    bit_preshift (sprite);
+
+    /* alignment 1 puts the sprite a pixel across and a row down */
+    for (m = 0; m < 5; ++m)
+	for (align = 0; align < 2; ++align) {
+	    draw = m;
+	    x = (align && w < 320 && sprite->shifts) ? 1 : 0;
+	    y = (align && h < 200) ? 1 : 0;
+	    measure ("bit_put", op_bit_put, modes[m], align, -1, -1,
+		     (long) (w / 4) * h);
+	    measure ("scr_put", op_scr_put, modes[m], align, -1, -1,
+		     (long) (w / 4) * h);
+	    x = 0;
+	    measure ("bit_putpart", op_bit_putpart, modes[m], align,
+		     -1, -1, (long) (w / 4) * (h / 2));
+	    measure ("scr_putpart", op_scr_putpart, modes[m], align,
+		     -1, -1, (long) (w / 4) * (h / 2));
+	}
+    bit_destroy (sprite);
+}
+
+/**
+ * Time the get and box operations for one size of bitmap.
+ * @param w is the width of the bitmap.
+ * @param h is the height of the bitmap.
+ */
+static void time_fills (int w, int h)
+{
+    /* local variables */
+    int ink; /* ink colour counter */
+    int align; /* alignment counter */
+
+    /* alignment 1 starts on an odd row */
+    sprite = bit_create (w, h);
+    x = 0;
+    for (align = 0; align < 2; ++align) {
+	y = (align && h < 200) ? 1 : 0;
+	measure ("bit_get", op_bit_get, "-", align, -1, -1,
+		 (long) (w / 4) * h);
+	measure ("scr_get", op_scr_get, "-", align, -1, -1,
+		 (long) (w / 4) * h);
+	for (ink = 0; ink < 4; ++ink) {
+	    bit_ink (canvas, ink);
+	    scr_ink (scr, ink);
+	    measure ("bit_box", op_bit_box, "-", align, ink, -1,
+		     (long) (w / 4) * h);
+	    measure ("scr_box", op_scr_box, "-", align, ink, -1,
+		     (long) (w / 4) * h);
+	}
+    }
+    bit_destroy (sprite);
+}
+
+/**
+ * Time the print operations for one message length.
+ * @param n is the length of the message.
+ */
+static void time_prints (int n)
+{
+    /* local variables */
+    int c; /* colour combination counter */
+    int align; /* alignment counter */
+
+    /* the sprite records the size of the printed area */
+    sprite = bit_create (4 * n, 8);
+    memset (message, 'A', n);
+    message[n] = '\0';
+    x = 0;
+    for (c = 0; c < 3; ++c)
+	for (align = 0; align < 2; ++align) {
+	    y = align;
+	    bit_ink (canvas, colours[c][0]);
+	    bit_paper (canvas, colours[c][1]);
+	    scr_ink (scr, colours[c][0]);
+	    scr_paper (scr, colours[c][1]);
+	    measure ("bit_print", op_bit_print, "-", align,
+		     colours[c][0], colours[c][1], 8L * n);
+	    measure ("scr_print", op_scr_print, "-", align,
+		     colours[c][0], colours[c][1], 8L * n);
+	}
+    bit_destroy (sprite);
+}
+
+/**
+ * Time a frame of moving sprites, drawn through a sprite layer and a
+ * compositor, and redrawn in full over the canvas as a background.
+ */
+static void time_frames (void)
+{
+    /* local variables */
+    int s; /* sprite counter */
+
+    /* a masked sprite with a square in the middle */
+    if (! (sprite = bit_create (16, 16))
+	|| ! (mask = bit_create (16, 16)))
+	error_handler (1, "Out of memory");
+    bit_ink (sprite, 0);
+    bit_box (sprite, 0, 0, 16, 16);
+    bit_ink (sprite, 2);
+    bit_box (sprite, 4, 4, 8, 8);
+    bit_ink (mask, 3);
+    bit_box (mask, 0, 0, 16, 16);
+    bit_ink (mask, 0);
+    bit_box (mask, 4, 4, 8, 8);
+
+    /* the layer takes off and redraws only the sprites that moved:
+       each writes its background, its mask and its image */
+    scr_put (scr, canvas, 0, 0, DRAW_PSET);
+    if (! (layer = spr_createlayer (scr)))
+	error_handler (1, "Out of memory");
+    for (s = 0; s < FRAME_SPRITES; ++s)
+	if (! (sprites[s] = spr_create (layer, sprite, mask, 0)))
+	    error_handler (1, "Out of memory");
+    frame = 0;
+    op_spr_update ();
+    measure ("spr_update", op_spr_update, "-", 0, -1, -1,
+	     3L * drawn * (sprite->width / 4) * sprite->height);
+    spr_destroylayer (layer);
+
+    /* a full redraw writes the whole background, then every sprite */
+    measure ("spr_redraw", op_spr_redraw, "-", 0, -1, -1,
+	     16000L + 2L * FRAME_SPRITES * (sprite->width / 4)
+	     * sprite->height);
+
+    /* the compositor puts only the cells that changed, keying the
+       sprites over the canvas; each cell is 16 bytes */
+    if (! (overlay = bit_create (320, 200))
+	|| ! (compositor = cmp_create (scr, 0, 0, 320, 200))
+	|| cmp_addlayer (compositor, canvas, NULL, CMP_OPAQUE) < 0
+	|| cmp_addlayer (compositor, overlay, NULL, CMP_KEYED) < 0)
+	error_handler (1, "Out of memory");
+    bit_ink (overlay, 0);
+    bit_box (overlay, 0, 0, 320, 200);
+    cmp_update (compositor);
+    op_cmp_update ();
+    measure ("cmp_update", op_cmp_update, "-", 0, -1, -1, 16L * cells);
+    op_cmp_redraw ();
+    measure ("cmp_redraw", op_cmp_redraw, "-", 0, -1, -1, 16L * cells);
+    cmp_destroy (compositor);
+    bit_destroy (overlay);
+    bit_destroy (mask);
+    bit_destroy (sprite);
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main program.
+ * @param argc is the number of command line arguments.
+ * @param argv is the command line arguments.
+ * No return value as exit () is used to terminate abnormally.
+ */
+void main (int argc, char **argv)
+{
+    /* local variables */
+    Font *font; /* a font for printing */
+    int c; /* counter */
+    long ms; /* milliseconds per repeat */
+
+    /* read the options: the milliseconds per repeat, and operation */
+    ms = 100;
+    filter = NULL;
+    for (c = 1; c < argc; ++c)
+	if (! strcmp (argv[c], "-t") && c + 1 < argc)
+	    ms = atol (argv[++c]);
+	else if (argv[c][0] == '-')
+	    error_handler (1, "Usage: bench [-t milliseconds] [operation]");
+	else
+	    filter = argv[c];
+    target = (clock_t) (ms * CLOCKS_PER_SEC / 1000);
+    if (target < 1)
+	target = 1;
+
+    /* create the screen, canvas and font */
+    bit_shiftlimit (65535L);
+    if (! (scr = scr_createmem (4))
+	|| ! (canvas = bit_create (320, 200))
+	|| ! (font = fnt_create (32, 127)))
+	error_handler (1, "Out of memory");
+    memset (font->pixels, 0x5a, 8 * 96);
+    bit_font (canvas, font);
+    scr_font (scr, font);
+    bit_box (canvas, 0, 0, 320, 200);
+
+    /* time each group of operations */
+    printf ("op,mode,width,height,align,ink,paper,count,"
+	    "ns_min,ns_median,ns_max,bytes_per_s,bytes\n");
+    for (c = 0; c < SIZES; ++c)
+	time_puts (sizes[c][0], sizes[c][1]);
+    for (c = 0; c < SIZES; ++c)
+	time_fills (sizes[c][0], sizes[c][1]);
+    for (c = 0; c < 3; ++c)
+	time_prints (lengths[c]);
+    time_frames ();
+
+    /* clean up */
+    fnt_destroy (font);
+    bit_destroy (canvas);
+    scr_destroy (scr);
+}
@@ -18,40 +18,517 @@
 #include <string.h>
 #include "cgalib.h"
 
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @var unpacked Lookup table of the four pixels in each byte value. */
+static char unpacked[256][4];
+
+/** @var unpacked_ready 1 if the unpacked table has been built. */
+static int unpacked_ready = 0;
+
+/** @var shift_memory Bytes used by pre-shifted copies. */
+static long shift_memory = 0;
+
+/** @var shift_limit Maximum bytes to use for pre-shifted copies. */
+static long shift_limit = 16384;
+
+/** @var packed Lookup table of each pixel value at each position. */
+static unsigned char packed[4][4] = {
+    {0x00, 0x40, 0x80, 0xc0},
+    {0x00, 0x10, 0x20, 0x30},
+    {0x00, 0x04, 0x08, 0x0c},
+    {0x00, 0x01, 0x02, 0x03}
+};
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Build the table used to unpack bytes into individual pixels. This is
+ * done once, the first time it is needed, so that unpacking needs
+ * only a table lookup per byte rather than a shift per pixel.
+ */
+static void build_unpacked (void)
+{
+    int v; /* byte value */
+    int p; /* pixel position within the byte */
+
+    for (v = 0; v < 256; ++v)
+	for (p = 0; p < 4; ++p)
+	    unpacked[v][p] = (v >> (6 - 2 * p)) & 3;
+    unpacked_ready = 1;
+}
+
+/**
+ * Put the partial byte at the edge of a pre-shifted row.
+ * @param d is the destination address.
+ * @param v is the shifted source byte.
+ * @param m is the mask of the pixels covered by the source.
+ * @param draw is the drawing mode to use.
+ */
+static void shift_edge (char far *d, char v, char m, DrawMode draw)
+{
+    switch (draw) {
+    case DRAW_PSET:
+	*d = (*d & ~m) | v;
+	break;
+    case DRAW_PRESET:
+	*d = (*d & ~m) | (~v & m);
+	break;
+    case DRAW_AND:
+	*d &= v | ~m;
+	break;
+    case DRAW_OR:
+	*d |= v;
+	break;
+    case DRAW_XOR:
+	*d ^= v;
+	break;
+    }
+}
+
+/**
+ * Work out the size of a bitmap's pre-shifted copies.
+ * @param bitmap is the bitmap.
+ * @returns the size in bytes.
+ */
+static long shift_size (Bitmap *bitmap)
+{
+    return 3L * (bitmap->width / 4 + 1) * bitmap->height;
+}
+
+/**
+ * Work out how much heap memory a bitmap holds, apart from any
+ * pre-shifted copies.
+ * @param bitmap is the bitmap, which is not in an arena or pool.
+ * @returns the size in bytes.
+ */
+static long heap_size (Bitmap *bitmap)
+{
+    /* a header inside a shared block is counted with the block */
+    if (bitmap->home)
+	return 0;
+
+    /* views and copies hold only their header */
+    if (bitmap->parent || bitmap->shared)
+	return sizeof (Bitmap);
+
+    /* paged bitmaps also hold their list of pages */
+    if (bitmap->pages)
+	return sizeof (Bitmap) + (long) bitmap->stride * bitmap->height
+	    + sizeof (char *) * ((bitmap->height + bitmap->pagerows - 1)
+				 / bitmap->pagerows);
+
+    /* ordinary bitmaps hold their header and pixels */
+    return sizeof (Bitmap) + (long) bitmap->stride * bitmap->height;
+}
+
+/**
+ * Start sharing a bitmap's pixels, if they are not shared already.
+ * @param bitmap is the bitmap whose pixels will be shared.
+ * @returns the shared block, or NULL if there was not enough memory.
+ */
+static struct pixelblock *share (Bitmap *bitmap)
+{
+    /* local variables */
+    struct pixelblock *block; /* the shared block */
+
+    /* pixels may already be shared */
+    if (bitmap->shared)
+	return bitmap->shared;
+
+    /* the block is the bitmap's own memory, referred to both for its
+       pixels and for its header */
+    if (! (block = mem_alloc (bitmap->allocator,
+			      sizeof (struct pixelblock))))
+	return NULL;
+    block->refs = 2;
+    block->users = 1;
+    block->block = bitmap;
+    block->size = sizeof (Bitmap) + sizeof (struct pixelblock)
+	+ (long) bitmap->stride * bitmap->height;
+    block->allocator = bitmap->allocator;
+    bitmap->shared = bitmap->home = block;
+    if (! block->allocator)
+	mem_account (MEM_BITMAP, sizeof (struct pixelblock), 0);
+    return block;
+}
+
+/**
+ * Move a bitmap's pixels back into its own memory, once no copy is
+ * using the pixels that were there.
+ * @param bitmap is the bitmap, whose pixels are in a separate block.
+ * @returns the block the pixels were in, for the caller to release.
+ */
+static struct pixelblock *go_home (Bitmap *bitmap)
+{
+    /* local variables */
+    struct pixelblock *block; /* the block being left */
+
+    block = bitmap->shared;
+    memcpy (bitmap + 1, bitmap->pixels,
+	    (size_t) bitmap->stride * bitmap->height);
+    bitmap->pixels = (char *) (bitmap + 1);
+    bitmap->shared = bitmap->home;
+    ++bitmap->home->refs;
+    ++bitmap->home->users;
+    return block;
+}
+
+/**
+ * Give up a reference to a shared block, freeing it with the last one.
+ * @param block is the shared block.
+ * @param pixels is 1 if the reference was to the pixels, 0 if it was
+ * to the header of the bitmap the block belongs to.
+ */
+static void release (struct pixelblock *block, int pixels)
+{
+    /* local variables */
+    Allocator *allocator; /* where the block came from */
+    Bitmap *owner; /* the bitmap whose memory holds the block */
+
+    /* once no copy uses the pixels in a bitmap's own memory, the bitmap
+       takes its pixels back if nothing else is sharing them */
+    if (pixels && ! --block->users && block->block != block) {
+	owner = block->block;
+	if (owner->shared && owner->shared != block
+	    && owner->shared->users == 1 && ! owner->views)
+	    release (go_home (owner), 1);
+    }
+
+    /* do nothing while others refer to the block */
+    if (--block->refs)
+	return;
+
+    /* free the memory, and the details if they are separate */
+    allocator = block->allocator;
+    if (! allocator)
+	mem_account (MEM_BITMAP, - block->size, 0);
+    if (block->block != block)
+	mem_free (allocator, block->block);
+    mem_free (allocator, block);
+}
+
+/**
+ * Put part of a bitmap onto another, for bit_putpart or bit_put.
+ * @param op is the function to count the bytes against.
+ * @param dst is the bitmap to affect.
+ * @param src is the source bitmap.
+ * @param xd is the x coordinate at which the bitmap is to be placed.
+ * @param yd is the y coordinate at which the bitmap is to be placed.
+ * @param xs is the x coordinate of the source to copy from.
+ * @param ys is the y coordinate of the source to copy from.
+ * @param w is the width of the section to copy.
+ * @param h is the height of the section to copy.
+ * @param draw is the draw mode.
+ */
+static void put_part (ProfileOp op, Bitmap *dst, Bitmap *src, int xd,
+		      int yd, int xs, int ys, int w, int h, DrawMode draw)
+{
+    /* local variables */
+    char *d; /* address to copy data to */
+    char *s; /* address to copy data from */
+    int r; /* row counter */
+    int y; /* destination row */
+    int dr; /* step between destination rows in bytes */
+    int sr; /* step between source rows in bytes */
+    int i; /* step between destination rows */
+    Bitmap band; /* a page of a paged source bitmap */
+    int first; /* first row of the page */
+
+    /* clip the area to be copied, once for the whole operation */
+    if (! bit_cliprect (&xd, &yd, &xs, &ys, &w, &h, dst->clipx,
+			dst->clipy, dst->clipw, dst->cliph)
+	|| ! bit_cliprect (&xs, &ys, &xd, &yd, &w, &h, 0, 0,
+			   src->width, src->height)
+	|| ! bit_own (dst))
+	return;
+
+    /* a paged bitmap is put a page at a time */
+    if (src->pages) {
+	for (; h > 0; h -= r, yd += r, ys += r) {
+	    first = bit_band (src, ys, &band);
+	    r = band.height - (ys - first);
+	    if (r > h)
+		r = h;
+	    put_part (op, dst, &band, xd, yd, xs, ys - first, w, r, draw);
+	}
+	return;
+    }
+
+    /* work out where to start */
+    PRF_BYTES (op, draw, 0, (draw >= DRAW_AND) ? (long) (w / 4) * h : 0L,
+	       (long) (w / 4) * h);
+    d = dst->pixels + xd / 4 + yd * dst->stride;
+    s = src->pixels + xs / 4 + ys * src->stride;
+    y = yd;
+    dr = dst->stride;
+    sr = src->stride;
+    i = 1;
+
+    /* a bitmap put further down onto itself is copied from the bottom
+       up, so that no row is overwritten before it has been copied */
+    if (d > s && d < s + (long) h * sr) {
+	d += (long) (h - 1) * dr;
+	s += (long) (h - 1) * sr;
+	y += h - 1;
+	dr = -dr;
+	sr = -sr;
+	i = -1;
+    }
+
+    /* copy the pixels */
+    for (r = 0; r < h; ++r) {
+	if (dst->region)
+	    rgn_putrow (dst->region, y, d, s, xd / 4, w / 4,
+			(char) 0xff, (char) 0xff, draw);
+	else
+	    bit_putrow (d, s, w / 4, draw);
+	d += dr;
+	s += sr;
+	y += i;
+    }
+}
+
+/*----------------------------------------------------------------------
+ * Internal Level Functions.
+ */
+
+/**
+ * Put one row of bitmap data in any draw mode. The source and
+ * destination may overlap.
+ * @param d is the address of the first destination byte.
+ * @param s is the address of the first source byte.
+ * @param n is the number of bytes in the row.
+ * @param draw is the drawing mode to use.
+ */
+void bit_putrow (char far *d, char *s, int n, DrawMode draw)
+{
+    /* local variables */
+    int b; /* byte counter */
+    int e; /* byte counter end value */
+    int i; /* byte counter increment */
+
+    /* DRAW_PSET can be copied by a quicker method */
+    if (draw == DRAW_PSET) {
+	_fmemmove (d, s, n);
+	return;
+    }
+
+    /* the others work from the right if moving data to the right */
+    if (d > s) {
+	b = n - 1;
+	e = -1;
+	i = -1;
+    } else {
+	b = 0;
+	e = n;
+	i = 1;
+    }
+
+    /* the other draw operations need doing byte by byte */
+    for (; b != e; b += i)
+	switch (draw) {
+	case DRAW_PRESET:
+	    d[b] = ~s[b];
+	    break;
+	case DRAW_AND:
+	    d[b] &= s[b];
+	    break;
+	case DRAW_OR:
+	    d[b] |= s[b];
+	    break;
+	case DRAW_XOR:
+	    d[b] ^= s[b];
+	    break;
+	}
+}
+
+/**
+ * Put one row of a pre-shifted bitmap.
+ * @param d is the address of the first destination byte.
+ * @param s is the address of the shifted source row.
+ * @param n is the number of bytes in the shifted row.
+ * @param left is the mask of pixels covered in the first byte.
+ * @param right is the mask of pixels covered in the last byte.
+ * @param draw is the drawing mode to use.
+ */
+void bit_shiftrow (char far *d, char *s, int n, char left, char right,
+		   DrawMode draw)
+{
+    /* a single byte is covered by both masks at once */
+    if (n == 1) {
+	shift_edge (d, *s, left & right, draw);
+	return;
+    }
+
+    /* otherwise the edges are masked and the middle put as is */
+    shift_edge (d, *s, left, draw);
+    bit_putrow (d + 1, s + 1, n - 2, draw);
+    shift_edge (d + n - 1, s[n - 1], right, draw);
+}
+
+/**
+ * Clip an area to be drawn to a clipping rectangle.
+ * @param xd points to the destination x coordinate.
+ * @param yd points to the destination y coordinate.
+ * @param xs points to the source x coordinate.
+ * @param ys points to the source y coordinate.
+ * @param w points to the width of the area.
+ * @param h points to the height of the area.
+ * @param cx is the x coordinate of the clipping rectangle.
+ * @param cy is the y coordinate of the clipping rectangle.
+ * @param cw is the width of the clipping rectangle.
+ * @param ch is the height of the clipping rectangle.
+ * @returns 1 if any of the area remains to be drawn, 0 if not.
+ */
+int bit_cliprect (int *xd, int *yd, int *xs, int *ys, int *w, int *h,
+		  int cx, int cy, int cw, int ch)
+{
+    /* local variables */
+    int c; /* amount to clip */
+
+    /* clip the left and right */
+    if ((c = cx - *xd) > 0) {
+	*xd += c;
+	*xs += c;
+	*w -= c;
+    }
+    if ((c = *xd + *w - cx - cw) > 0)
+	*w -= c;
+
+    /* clip the top and bottom */
+    if ((c = cy - *yd) > 0) {
+	*yd += c;
+	*ys += c;
+	*h -= c;
+    }
+    if ((c = *yd + *h - cy - ch) > 0)
+	*h -= c;
+
+    /* return true if there's anything left */
+    return *w > 0 && *h > 0;
+}
+
+/**
+ * Find the address of a row of a bitmap, which may be paged.
+ * @param bitmap is the bitmap.
+ * @param y is the row.
+ * @returns the address of the first byte of the row.
+ */
+char *bit_row (Bitmap *bitmap, int y)
+{
+    if (bitmap->pages)
+	return bitmap->pages[y / bitmap->pagerows]
+	    + (y % bitmap->pagerows) * bitmap->stride;
+    return bitmap->pixels + y * bitmap->stride;
+}
+
+/**
+ * Describe the page of a paged bitmap that contains a row, as an
+ * ordinary bitmap.
+ * @param paged is the paged bitmap.
+ * @param y is the row.
+ * @param band is the bitmap to fill in with the page's details.
+ * @returns the number of the page's first row in the paged bitmap.
+ */
+int bit_band (Bitmap *paged, int y, Bitmap *band)
+{
+    /* local variables */
+    int first; /* first row of the page */
+
+    /* describe the page as a view of the paged bitmap */
+    first = y - y % paged->pagerows;
+    *band = *paged;
+    band->pixels = paged->pages[y / paged->pagerows];
+    band->height = paged->height - first;
+    if (band->height > paged->pagerows)
+	band->height = paged->pagerows;
+    band->parent = paged;
+    band->pages = NULL;
+    band->pagerows = 0;
+    band->shifts = NULL;
+    return first;
+}
+
+/**
+ * Add bytes to a running FNV-1a hash of an image.
+ * @param hash is the hash so far.
+ * @param s is the address of the first byte.
+ * @param n is the number of bytes.
+ * @returns the new hash.
+ * The hash is kept to 32 bits so that it is the same on any compiler.
+ */
+unsigned long bit_hashrow (unsigned long hash, char far *s, int n)
+{
+    while (n--)
+	hash = ((hash ^ (unsigned char) *s++) * 16777619UL)
+	    & 0xffffffffUL;
+    return hash;
+}
+
 /*----------------------------------------------------------------------
  * Public Level Functions.
  */
 
 /**
- * Create a bitmap.
+ * Create a bitmap using a particular allocator.
+ * @param allocator is the arena or pool, or NULL for the heap.
  * @param width is the width of the bitmap.
  * @param height is the height of the bitmap.
  * @returns a new Bitmap.
  */
-Bitmap *bit_create (int width, int height)
+Bitmap *bit_createin (Allocator *allocator, int width, int height)
 {
     /* local variables */
     Bitmap *bitmap;
+    long size; /* size of the bitmap and its pixels */
 
-    /* reserve memory */
-    if (! (bitmap = malloc (sizeof (Bitmap))))
+    /* reserve memory for the bitmap and its pixels in one block */
+    size = sizeof (Bitmap) + (long) (width / 4) * height;
+    if (size != (long) (size_t) size
+	|| ! (bitmap = mem_alloc (allocator, (size_t) size)))
         return NULL;
-    if (! (bitmap->pixels = malloc (width / 4 * height))) {
-        free (bitmap);
-        return NULL;
-    }
 
     /* initialise the data */
     bitmap->width = width;
     bitmap->height = height;
+    bitmap->pixels = (char *) (bitmap + 1);
+    bitmap->stride = width / 4;
+    bitmap->parent = NULL;
+    bitmap->pages = NULL;
+    bitmap->pagerows = 0;
+    bitmap->allocator = allocator;
+    bitmap->shared = NULL;
+    bitmap->home = NULL;
+    bitmap->views = 0;
     bitmap->ink = 3;
     bitmap->paper = 0;
     bitmap->font = NULL;
+    bitmap->shifts = NULL;
+    bitmap->region = NULL;
+    bit_clip (bitmap, 0, 0, width, height);
+    if (! allocator)
+	mem_account (MEM_BITMAP, heap_size (bitmap), 1);
 
     /* return the bitmap */
     return bitmap;
 }
 
+/**
+ * Create a bitmap.
+ * @param width is the width of the bitmap.
+ * @param height is the height of the bitmap.
+ * @returns a new Bitmap.
+ */
+Bitmap *bit_create (int width, int height)
+{
+    return bit_createin (mem_installed (), width, height);
+}
+
 /**
  * Create a bitmap by copying another.
  * @param src is the bitmap to copy.
@@ -61,28 +538,181 @@ Bitmap *bit_copy (Bitmap *src)
 {
     /* local variables */
     Bitmap *dst;
+    int r; /* row counter */
+
+    /* an ordinary bitmap shares its pixels with the copy until one of
+       them is written to */
+    if (! src->parent && ! src->pages && ! src->views) {
+	if (! share (src)
+	    || ! (dst = mem_alloc (mem_installed (), sizeof (Bitmap))))
+	    return NULL;
+	*dst = *src;
+	dst->allocator = mem_installed ();
+	dst->home = NULL;
+	dst->shifts = NULL;
+	++dst->shared->refs;
+	++dst->shared->users;
+	if (! dst->allocator)
+	    mem_account (MEM_BITMAP, heap_size (dst), 1);
+	return dst;
+    }
 
     /* reserve memory */
-    if (! (dst = malloc (sizeof (Bitmap))))
-        return NULL;
-    if (! (dst->pixels = malloc (src->width / 4 * src->height))) {
-        free (dst);
+    if (! (dst = bit_create (src->width, src->height)))
         return NULL;
-    }
 
     /* initialise the data */
-    dst->width = src->width;
-    dst->height = src->height;
     dst->ink = src->ink;
     dst->paper = src->paper;
     dst->font = src->font;
-    memcpy (dst->pixels, src->pixels, src->width / 4 * src->height);
+    dst->region = src->region;
+    bit_clip (dst, src->clipx, src->clipy, src->clipw, src->cliph);
+
+    /* copy the pixels, which may not be contiguous in a view */
+    for (r = 0; r < src->height; ++r)
+	memcpy (dst->pixels + dst->stride * r, bit_row (src, r),
+		dst->stride);
 
     /* return the bitmap */
     return dst;
 
 }
 
+/**
+ * Create a bitmap that shares part of another bitmap's pixels.
+ * @param parent is the bitmap to view.
+ * @param x is the x coordinate of the view within the parent.
+ * @param y is the y coordinate of the view within the parent.
+ * @param width is the width of the view.
+ * @param height is the height of the view.
+ * @returns a new Bitmap.
+ */
+Bitmap *bit_view (Bitmap *parent, int x, int y, int width, int height)
+{
+    /* local variables */
+    Bitmap *view; /* the view to return */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+
+    Bitmap band; /* the page of a paged parent containing the view */
+    char *pixels; /* the pixels containing the view */
+
+    /* keep the view within the parent */
+    xs = ys = 0;
+    if (! bit_cliprect (&x, &y, &xs, &ys, &width, &height,
+			0, 0, parent->width, parent->height))
+	return NULL;
+
+    /* the parent's pixels must be its own before they are viewed */
+    if (! parent->pages && ! bit_own (parent))
+	return NULL;
+
+    /* a view of a paged bitmap must lie within a single page */
+    pixels = parent->pixels;
+    if (parent->pages) {
+	y -= bit_band (parent, y, &band);
+	if (y + height > band.height)
+	    return NULL;
+	pixels = band.pixels;
+    }
+
+    /* reserve memory */
+    if (! (view = mem_alloc (mem_installed (), sizeof (Bitmap))))
+	return NULL;
+
+    /* initialise the data, sharing the parent's pixels */
+    view->width = width;
+    view->height = height;
+    view->pixels = pixels + x / 4 + y * parent->stride;
+    view->stride = parent->stride;
+    view->parent = parent;
+    view->pages = NULL;
+    view->pagerows = 0;
+    view->allocator = mem_installed ();
+    view->shared = NULL;
+    view->home = NULL;
+    view->views = 0;
+    view->ink = parent->ink;
+    view->paper = parent->paper;
+    view->font = parent->font;
+    view->shifts = NULL;
+    view->region = NULL;
+    bit_clip (view, 0, 0, width, height);
+    ++parent->views;
+    if (! view->allocator)
+	mem_account (MEM_BITMAP, heap_size (view), 1);
+
+    /* return the view */
+    return view;
+}
+
+/**
+ * Create a bitmap whose pixels are kept in separate pages.
+ * @param width is the width of the bitmap.
+ * @param height is the height of the bitmap.
+ * @param rows is the number of rows in each page.
+ * @returns a new Bitmap.
+ */
+Bitmap *bit_createpaged (int width, int height, int rows)
+{
+    /* local variables */
+    Bitmap *bitmap; /* the bitmap to return */
+    int count; /* number of pages */
+    int p; /* page counter */
+    long size; /* size of a page in bytes */
+
+    /* work out the number and size of the pages */
+    if (rows <= 0 || height <= 0)
+	return NULL;
+    count = (height + rows - 1) / rows;
+    size = (long) (width / 4) * rows;
+    if (size != (long) (size_t) size)
+	return NULL;
+
+    /* reserve memory for the bitmap and its list of pages */
+    if (! (bitmap = malloc (sizeof (Bitmap))))
+	return NULL;
+    if (! (bitmap->pages = malloc (count * sizeof (char *)))) {
+	free (bitmap);
+	return NULL;
+    }
+
+    /* reserve memory for each page, the last one only as big as needed */
+    for (p = 0; p < count; ++p) {
+	if (p == count - 1)
+	    size = (long) (width / 4) * (height - p * rows);
+	if (! (bitmap->pages[p] = malloc ((size_t) size))) {
+	    while (p--)
+		free (bitmap->pages[p]);
+	    free (bitmap->pages);
+	    free (bitmap);
+	    return NULL;
+	}
+    }
+
+    /* initialise the data */
+    bitmap->width = width;
+    bitmap->height = height;
+    bitmap->stride = width / 4;
+    bitmap->parent = NULL;
+    bitmap->pixels = bitmap->pages[0];
+    bitmap->pagerows = rows;
+    bitmap->allocator = NULL;
+    bitmap->shared = NULL;
+    bitmap->home = NULL;
+    bitmap->views = 0;
+    bitmap->ink = 3;
+    bitmap->paper = 0;
+    bitmap->font = NULL;
+    bitmap->shifts = NULL;
+    bitmap->region = NULL;
+    bit_clip (bitmap, 0, 0, width, height);
+    mem_account (MEM_BITMAP, heap_size (bitmap), 1);
+
+    /* return the bitmap */
+    return bitmap;
+}
+
 /**
  * Read a bitmap from an already-open file.
  * @param input is the input file handle.
@@ -102,27 +732,15 @@ Bitmap *bit_read (FILE *input)
         return NULL;
     
     /* reserve memory for bitmap and its pixels */
-    if (! (bitmap = malloc (sizeof (Bitmap))))
+    if (! (bitmap = bit_create (w, h)))
         return NULL;
-    if (! (bitmap->pixels = malloc (w / 4 * h))) {
-        free (bitmap);
-        return NULL;
-    }
 
     /* attempt to read the pixels */
     if (! fread (bitmap->pixels, w / 4 * h, 1, input)) {
-        free (bitmap->pixels);
-        free (bitmap);
+        bit_destroy (bitmap);
         return NULL;
     }
 
-    /* set the rest of the variables in the bitmap */
-    bitmap->width = w;
-    bitmap->height = h;
-    bitmap->ink = 3;
-    bitmap->paper = 0;
-    bitmap->font = NULL;
-
     /* return the bitmap */
     return bitmap;
 }
@@ -134,13 +752,39 @@ Bitmap *bit_read (FILE *input)
  */
 void bit_write (Bitmap *bitmap, FILE *output)
 {
+    /* local variables */
+    int r; /* row counter */
+
     if (! fwrite (&bitmap->width, 2, 1, output))
         return;
     if (! fwrite (&bitmap->height, 2, 1, output))
         return;
-    if (! fwrite (bitmap->pixels, bitmap->width / 4 * bitmap->height, 1,
-        output))
-        return;
+    for (r = 0; r < bitmap->height; ++r)
+	if (! fwrite (bit_row (bitmap, r), bitmap->width / 4, 1, output))
+	    return;
+}
+
+/**
+ * Calculate a hash of a bitmap's size and pixels.
+ * @param bitmap is the bitmap to hash.
+ * @returns the hash.
+ */
+unsigned long bit_hash (Bitmap *bitmap)
+{
+    /* local variables */
+    char size[4]; /* the width and height, low byte first */
+    unsigned long hash; /* the hash to return */
+    int r; /* row counter */
+
+    /* hash the size, then the pixels a row at a time */
+    size[0] = bitmap->width & 0xff;
+    size[1] = bitmap->width >> 8;
+    size[2] = bitmap->height & 0xff;
+    size[3] = bitmap->height >> 8;
+    hash = bit_hashrow (2166136261UL, size, 4);
+    for (r = 0; r < bitmap->height; ++r)
+	hash = bit_hashrow (hash, bit_row (bitmap, r), bitmap->width / 4);
+    return hash;
 }
 
 /**
@@ -158,44 +802,10 @@ void bit_write (Bitmap *bitmap, FILE *output)
 void bit_putpart (Bitmap *dst, Bitmap *src, int xd, int yd,
 		  int xs, int ys, int w, int h, DrawMode draw)
 {
-    /* local variables */
-    char *d; /* address to copy data to */
-    char *s; /* address to copy data from */
-    int r; /* row counter */
-    int b; /* byte counter */
-
-    /* copy the pixels */
-    for (r = 0; r < h; ++r)
-
-        /* DRAW_PSET can be copied by a quicker method */
-        if (draw == DRAW_PSET) {
-            d = dst->pixels + xd / 4 + (yd + r) * (dst->width / 4);
-            s = src->pixels + (xs / 4) + (src->width / 4) * (ys + r);
-            _fmemcpy (d, s, w / 4);
-        }
-        
-        /* the other draw operations need doing byte by byte */
-        else 
-            for (b = 0; b < w / 4; ++b) {
-                d = dst->pixels + b + xd / 4
-                    + (yd + r) * (dst->width / 4);
-                s = b + src->pixels + (xs / 4)
-		    + (src->width) / 4 * (ys + r);
-                switch (draw) {
-                    case DRAW_PRESET:
-                        *d = ~*s;
-                        break;
-                    case DRAW_AND:
-                        *d &= *s;
-                        break;
-                    case DRAW_OR:
-                        *d |= *s;
-                        break;
-                    case DRAW_XOR:
-                        *d ^= *s;
-                        break;
-                }
-            }
+    PRF_CALL (PRF_BIT_PUTPART, draw, dst);
+    REC_PUTPART (dst, 0, src, xd, yd, xs, ys, w, h, draw);
+    put_part (PRF_BIT_PUTPART, dst, src, xd, yd, xs, ys, w, h, draw);
+    PRF_END (PRF_BIT_PUTPART);
 }
 
 /**
@@ -212,39 +822,119 @@ void bit_put (Bitmap *dst, Bitmap *src, int x, int y, DrawMode draw)
     char *d; /* address to copy data to */
     char *s; /* address to copy data from */
     int r; /* row counter */
-    int b; /* byte counter */
+    int xd; /* clipped destination x coordinate */
+    int yd; /* clipped destination y coordinate */
+    int xs; /* clipped source x coordinate */
+    int ys; /* clipped source y coordinate */
+    int w; /* clipped width */
+    int h; /* clipped height */
+    int n; /* bytes per row of shifted copy */
+    char left; /* mask for the left edge of a shifted copy */
+    char right; /* mask for the right edge of a shifted copy */
+
+    /* count and record; bitmaps on the byte boundary are put whole */
+    PRF_CALL (PRF_BIT_PUT, draw, dst);
+    REC_PUT (dst, 0, src, x, y, draw);
+    if (! (x & 3) || ! src->shifts) {
+	put_part (PRF_BIT_PUT, dst, src, x, y, 0, 0, src->width,
+		  src->height, draw);
+	PRF_END (PRF_BIT_PUT);
+	return;
+    }
+
+    /* others are put from a shifted copy, a byte wider */
+    n = src->width / 4 + 1;
+    xd = x & ~3;
+    yd = y;
+    xs = ys = 0;
+    w = 4 * n;
+    h = src->height;
+    if (! bit_cliprect (&xd, &yd, &xs, &ys, &w, &h, dst->clipx,
+			dst->clipy, dst->clipw, dst->cliph)
+	|| ! bit_own (dst)) {
+	PRF_END (PRF_BIT_PUT);
+	return;
+    }
+
+    /* edges that have been clipped are no longer partial */
+    left = xs ? 0xff : 0xff >> (2 * (x & 3));
+    right = (xs + w < 4 * n) ? 0xff : ~(0xff >> (2 * (x & 3)));
 
     /* copy the pixels */
-    for (r = 0; r < src->height; ++r)
+    PRF_BYTES (PRF_BIT_PUT, draw, 0,
+	       (draw >= DRAW_AND) ? (long) (w / 4) * h : 0L,
+	       (long) (w / 4) * h);
+    d = dst->pixels + xd / 4 + yd * dst->stride;
+    s = src->shifts + (long) ((x & 3) - 1) * n * src->height
+	+ xs / 4 + ys * n;
+    for (r = 0; r < h; ++r) {
+	if (dst->region)
+	    rgn_putrow (dst->region, yd + r, d, s, xd / 4, w / 4,
+			left, right, draw);
+	else
+	    bit_shiftrow (d, s, w / 4, left, right, draw);
+	d += dst->stride;
+	s += n;
+    }
+    PRF_END (PRF_BIT_PUT);
+}
+
+/**
+ * Put a compiled sprite onto a bitmap.
+ * @param dst is the destination bitmap.
+ * @param src is the compiled sprite.
+ * @param x is the x coordinate on the destination bitmap.
+ * @param y is the y coordinate on the destination bitmap.
+ */
+void bit_putcompiled (Bitmap *dst, Compiled *src, int x, int y)
+{
+    /* local variables */
+    struct compiledrun *run; /* current run */
+    char *s; /* address to copy data from */
+    int c; /* run counter */
+    int r; /* destination row */
+    int n; /* bytes put from the current run */
+    int xd; /* clipped destination x coordinate */
+    int yd; /* clipped destination y coordinate */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+    int w; /* clipped width */
+    int h; /* clipped height */
+    long read; /* bytes read back from the destination */
+    long written; /* bytes written to the destination */
+
+    /* clip the sprite's rectangle */
+    PRF_CALL (PRF_BIT_PUTCOMPILED, DRAW_PSET, dst);
+    REC_PUTCOMPILED (dst, 0, src, x, y);
+    xd = x;
+    yd = y;
+    xs = ys = 0;
+    w = src->width;
+    h = src->height;
+    if (! bit_cliprect (&xd, &yd, &xs, &ys, &w, &h, dst->clipx,
+			dst->clipy, dst->clipw, dst->cliph)
+	|| ! bit_own (dst)) {
+	PRF_END (PRF_BIT_PUTCOMPILED);
+	return;
+    }
 
-        /* DRAW_PSET can be copied by a quicker method */
-        if (draw == DRAW_PSET) {
-            d = dst->pixels + x / 4 + (y + r) * (dst->width / 4);
-            s = src->pixels + src->width / 4 * r;
-            _fmemcpy (d, s, src->width / 4);
-        }
-        
-        /* the other draw operations need doing byte by byte */
-        else 
-            for (b = 0; b < src->width / 4; ++b) {
-                d = dst->pixels + b + x / 4
-                    + (y + r) * (dst->width / 4);
-                s = b + src->pixels + src->width / 4 * r;
-                switch (draw) {
-                    case DRAW_PRESET:
-                        *d = ~*s;
-                        break;
-                    case DRAW_AND:
-                        *d &= *s;
-                        break;
-                    case DRAW_OR:
-                        *d |= *s;
-                        break;
-                    case DRAW_XOR:
-                        *d ^= *s;
-                        break;
-                }
-            }
+    /* opaque runs are copied, masked runs combined byte by byte */
+    read = written = 0;
+    s = src->data;
+    for (c = 0, run = src->runs; c < src->count; ++c, ++run) {
+	if ((r = y + run->row) >= yd + h)
+	    break;
+	if (r >= yd) {
+	    n = cpl_putrun (run, dst->pixels + r * dst->stride, s, x / 4,
+			    r, xd / 4, (xd + w) / 4, dst->region);
+	    written += n;
+	    if (run->masked)
+		read += n;
+	}
+	s += run->masked ? 2 * run->length : run->length;
+    }
+    PRF_BYTES (PRF_BIT_PUTCOMPILED, DRAW_PSET, 0, read, written);
+    PRF_END (PRF_BIT_PUTCOMPILED);
 }
 
 /**
@@ -262,11 +952,92 @@ void bit_get (Bitmap *src, Bitmap *dst, int x, int y)
     int r; /* row counter */
 
     /* copy the pixels */
+    PRF_CALL (PRF_BIT_GET, DRAW_PSET, src);
+    REC_GET (src, 0, dst, x, y);
+    if (! bit_own (dst)) {
+	PRF_END (PRF_BIT_GET);
+	return;
+    }
+    PRF_BYTES (PRF_BIT_GET, DRAW_PSET, 0,
+	       (long) (dst->width / 4) * dst->height, 0L);
     for (r = 0; r < dst->height; ++r) {
-        s = src->pixels + x / 4 + (y + r) * (src->width / 4);
-        d = dst->pixels + dst->width / 4 * r;
+        s = bit_row (src, y + r) + x / 4;
+        d = dst->pixels + dst->stride * r;
         _fmemcpy (d, s, dst->width / 4);
     }
+    PRF_END (PRF_BIT_GET);
+}
+
+/**
+ * Unpack a bitmap into a buffer of one byte per pixel.
+ * @param src is the source bitmap.
+ * @param dst is the destination buffer, width * height bytes long.
+ */
+void bit_unpack (Bitmap *src, char *dst)
+{
+    /* local variables */
+    char *s; /* address to unpack data from */
+    char *t; /* table entry for the current byte */
+    int r; /* row counter */
+    int b; /* byte counter */
+
+    /* count the call, and make sure the lookup table is ready */
+    PRF_CALL (PRF_BIT_UNPACK, DRAW_PSET, src);
+    if (src->pages) {
+	PRF_END (PRF_BIT_UNPACK);
+	return;
+    }
+    PRF_BYTES (PRF_BIT_UNPACK, DRAW_PSET, 0,
+	       (long) (src->width / 4) * src->height, 0L);
+    if (! unpacked_ready)
+	build_unpacked ();
+
+    /* unpack each byte of each row into four pixels */
+    for (r = 0; r < src->height; ++r) {
+	s = src->pixels + src->stride * r;
+	for (b = 0; b < src->width / 4; ++b) {
+	    t = unpacked[(unsigned char) *s++];
+	    *dst++ = t[0];
+	    *dst++ = t[1];
+	    *dst++ = t[2];
+	    *dst++ = t[3];
+	}
+    }
+    PRF_END (PRF_BIT_UNPACK);
+}
+
+/**
+ * Pack a buffer of one byte per pixel into a bitmap.
+ * @param dst is the destination bitmap, whose size is already set.
+ * @param src is the source buffer, width * height bytes long.
+ */
+void bit_pack (Bitmap *dst, char *src)
+{
+    /* local variables */
+    char *d; /* address to pack data to */
+    int r; /* row counter */
+    int b; /* byte counter */
+
+    /* pack each group of four pixels into a byte */
+    PRF_CALL (PRF_BIT_PACK, DRAW_PSET, dst);
+    if (! bit_own (dst)) {
+	PRF_END (PRF_BIT_PACK);
+	return;
+    }
+    PRF_BYTES (PRF_BIT_PACK, DRAW_PSET, 0, 0L,
+	       (long) (dst->width / 4) * dst->height);
+    for (r = 0; r < dst->height; ++r) {
+	d = dst->pixels + dst->stride * r;
+	for (b = 0; b < dst->width / 4; ++b) {
+	    *d++ = packed[0][src[0] & 3]
+		| packed[1][src[1] & 3]
+		| packed[2][src[2] & 3]
+		| packed[3][src[3] & 3];
+	    src += 4;
+	}
+    }
+    REC_LOAD (dst);
+    PRF_END (PRF_BIT_PACK);
 }
 
 /**
@@ -285,15 +1056,110 @@ void bit_box (Bitmap *bitmap, int x, int y, int width, int height)
     char v; /* value to write to the screen */
     int r; /* row counter */
     char *d; /* address to write to */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+    int i; /* clip region span counter */
+    int a; /* first byte of a piece of a row */
+    int e; /* byte after a piece of a row */
+
+    /* count and record the call, and clip the box */
+    PRF_CALL (PRF_BIT_BOX, DRAW_PSET, bitmap);
+    REC_BOX (bitmap, 0, x, y, width, height);
+    xs = ys = 0;
+    if (! bit_cliprect (&x, &y, &xs, &ys, &width, &height, bitmap->clipx,
+			bitmap->clipy, bitmap->clipw, bitmap->cliph)
+	|| ! bit_own (bitmap)) {
+	PRF_END (PRF_BIT_BOX);
+	return;
+    }
+    PRF_BYTES (PRF_BIT_BOX, DRAW_PSET, 0, 0L, (long) (width / 4) * height);
 
     /* determine the byte value that will fill the box */
     v = bitmap->ink * 0x55;
 
-    /* fill each individual row */
+    /* fill each individual row, or the parts in the clip region */
     for (r = 0; r < height; ++r) {
-        d = bitmap->pixels + x / 4 + (y + r) * (bitmap->width / 4);
-        _fmemset (d, v, width / 4);
+        d = bitmap->pixels + (y + r) * bitmap->stride;
+	for (i = 0; rgn_next (bitmap->region, y + r, x / 4, width / 4,
+			      &i, &a, &e); )
+	    _fmemset (d + a, v, e - a);
     }
+    PRF_END (PRF_BIT_BOX);
+}
+
+/**
+ * Scroll an area of a bitmap in place.
+ * @param bitmap is the bitmap to affect.
+ * @param x is the x coordinate of the area to scroll.
+ * @param y is the y coordinate of the area to scroll.
+ * @param width is the width of the area to scroll.
+ * @param height is the height of the area to scroll.
+ * @param dx is the distance to move right, or left if negative.
+ * @param dy is the distance to move down, or up if negative.
+ * @param fill is the colour for the exposed area, or -1 to leave it.
+ */
+void bit_scroll (Bitmap *bitmap, int x, int y, int width, int height,
+		 int dx, int dy, int fill)
+{
+    /* local variables */
+    char *d; /* address to move data to */
+    int r; /* row counter */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+    int n; /* bytes moved in each row */
+    int h; /* number of rows moved */
+    int top; /* first row moved, relative to the area */
+    int step; /* step between rows in bytes */
+
+    /* count and record the call, and clip the area */
+    PRF_CALL (PRF_BIT_SCROLL, DRAW_PSET, bitmap);
+    REC_SCROLL (bitmap, 0, x, y, width, height, dx, dy, fill);
+    xs = ys = 0;
+    if (! bit_cliprect (&x, &y, &xs, &ys, &width, &height, bitmap->clipx,
+			bitmap->clipy, bitmap->clipw, bitmap->cliph)
+	|| ! bit_own (bitmap)) {
+	PRF_END (PRF_BIT_SCROLL);
+	return;
+    }
+
+    /* work out how much of the area is moved */
+    n = width / 4 - ((dx < 0) ? -dx : dx) / 4;
+    h = height - ((dy < 0) ? -dy : dy);
+    if (n < 0 || h < 0)
+	n = h = 0;
+    top = (dy > 0) ? dy : 0;
+    PRF_BYTES (PRF_BIT_SCROLL, DRAW_PSET, 0, (long) n * h,
+	       (fill < 0) ? (long) n * h : (long) (width / 4) * height);
+
+    /* move the rows, working from the bottom when moving down so that
+       no row is overwritten before it has been moved */
+    d = bitmap->pixels + x / 4 + ((dx > 0) ? dx / 4 : 0)
+	+ (y + top) * bitmap->stride;
+    step = bitmap->stride;
+    if (dy > 0) {
+	d += (long) (h - 1) * step;
+	step = -step;
+    }
+    for (r = 0; r < h; ++r) {
+	_fmemmove (d, d - dx / 4 - dy * bitmap->stride, n);
+	d += step;
+    }
+
+    /* fill the exposed rows, and the exposed ends of the moved ones */
+    if (fill < 0) {
+	PRF_END (PRF_BIT_SCROLL);
+	return;
+    }
+    for (r = 0; r < height; ++r) {
+	d = bitmap->pixels + x / 4 + (y + r) * bitmap->stride;
+	if (r < top || r >= top + h)
+	    _fmemset (d, fill * 0x55, width / 4);
+	else if (dx > 0)
+	    _fmemset (d, fill * 0x55, width / 4 - n);
+	else if (dx < 0)
+	    _fmemset (d + n, fill * 0x55, width / 4 - n);
+    }
+    PRF_END (PRF_BIT_SCROLL);
 }
 
 /**
@@ -311,22 +1177,48 @@ void bit_print (Bitmap *bitmap, int x, int y, char *message)
     int r; /* row of character */
     char v; /* value of byte in character */
     char *d; /* pointer to destination byte on screen */
+    int i; /* clip region span counter */
+    int a; /* first byte of a piece of a row */
+    int e; /* byte after a piece of a row */
+    int xd; /* clipped x coordinate */
+    int yd; /* clipped y coordinate */
+    int xs; /* clipped x coordinate within the text */
+    int ys; /* first row of the characters to print */
+    int w; /* clipped width */
+    int h; /* clipped height */
 
-    /* only try to print if a font is selected */
-    if (! bitmap->font) return;
+    /* count and record the call, but only print if a font is selected */
+    PRF_CALL (PRF_BIT_PRINT, DRAW_PSET, bitmap);
+    REC_PRINT (bitmap, 0, x, y, message);
+    xd = x;
+    yd = y;
+    xs = ys = 0;
+    w = 4 * (int) strlen (message);
+    h = 8;
+    if (! bitmap->font
+	|| ! bit_cliprect (&xd, &yd, &xs, &ys, &w, &h, bitmap->clipx,
+			   bitmap->clipy, bitmap->clipw, bitmap->cliph)
+	|| ! bit_own (bitmap)) {
+	PRF_END (PRF_BIT_PRINT);
+	return;
+    }
 
-    /* print each character */
-    for (b = 0; message[b]; ++b)
-        for (r = 0; r < 8; ++r) {
-            d = bitmap->pixels + b + x / 4 +
-                (y + r) * (bitmap->width / 4);
-            v = bitmap->font->pixels[r + 8
-                * (message[b] - bitmap->font->first)];
-            if (bitmap->ink != 3 || bitmap->paper != 0)
-                v = (v & 0x55 * bitmap->ink)
-                    | ((0xff ^ v) & 0x55 * bitmap->paper);
-            *d = v;
-        }
+    /* print each row of the characters within the clip region */
+    PRF_BYTES (PRF_BIT_PRINT, DRAW_PSET, 0, 0L, (long) (w / 4) * h);
+    for (r = ys; r < ys + h; ++r)
+	for (i = 0; rgn_next (bitmap->region, y + r, xd / 4, w / 4,
+			      &i, &a, &e); )
+	    for (b = a - x / 4; b < e - x / 4; ++b) {
+		d = bitmap->pixels + b + x / 4 +
+		    (y + r) * bitmap->stride;
+		v = bitmap->font->pixels[r + 8
+		    * (message[b] - bitmap->font->first)];
+		if (bitmap->ink != 3 || bitmap->paper != 0)
+		    v = (v & 0x55 * bitmap->ink)
+			| ((0xff ^ v) & 0x55 * bitmap->paper);
+		*d = v;
+	    }
+    PRF_END (PRF_BIT_PRINT);
 }
 
 /**
@@ -359,15 +1251,189 @@ void bit_font (Bitmap *bitmap, Font *font)
     bitmap->font = font;
 }
 
+/**
+ * Set the clipping rectangle for put and box operations.
+ * @param bitmap is the bitmap to set the clipping rectangle for.
+ * @param x is the x coordinate of the clipping rectangle.
+ * @param y is the y coordinate of the clipping rectangle.
+ * @param width is the width of the clipping rectangle.
+ * @param height is the height of the clipping rectangle.
+ */
+void bit_clip (Bitmap *bitmap, int x, int y, int width, int height)
+{
+    /* local variables */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+
+    /* keep the rectangle within the bitmap itself */
+    xs = ys = 0;
+    if (! bit_cliprect (&x, &y, &xs, &ys, &width, &height,
+			0, 0, bitmap->width, bitmap->height))
+	width = height = 0;
+    bitmap->clipx = x;
+    bitmap->clipy = y;
+    bitmap->clipw = width;
+    bitmap->cliph = height;
+}
+
+/**
+ * Attach a clip region to a bitmap.
+ * @param bitmap is the bitmap to attach the region to.
+ * @param region is the clip region, or NULL to remove it.
+ */
+void bit_region (Bitmap *bitmap, ClipRegion *region)
+{
+    bitmap->region = region;
+}
+
+/**
+ * Build the pre-shifted copies used to put a bitmap at any x.
+ * @param bitmap is the bitmap to pre-shift.
+ * @returns 1 on success, 0 if there is not enough memory.
+ */
+int bit_preshift (Bitmap *bitmap)
+{
+    /* local variables */
+    long size; /* size of the shifted copies */
+    char *s; /* address to shift data from */
+    char *d; /* address to shift data to */
+    int shift; /* shift in pixels */
+    int r; /* row counter */
+    int b; /* byte counter */
+    unsigned char v; /* source byte */
+    unsigned char carry; /* pixels carried into the next byte */
+
+    /* paged bitmaps are too big to pre-shift */
+    if (bitmap->pages)
+	return 0;
+
+    /* reserve memory, unless the bitmap is being pre-shifted again */
+    size = shift_size (bitmap);
+    if (! bitmap->shifts) {
+	if (shift_memory + size > shift_limit
+	    || size != (long) (size_t) size
+	    || ! (bitmap->shifts = malloc ((size_t) size)))
+	    return 0;
+	shift_memory += size;
+	mem_account (MEM_CACHE, size, 1);
+    }
+
+    /* build each copy, one byte wider than the bitmap */
+    d = bitmap->shifts;
+    for (shift = 1; shift <= 3; ++shift)
+	for (r = 0; r < bitmap->height; ++r) {
+	    s = bitmap->pixels + bitmap->stride * r;
+	    carry = 0;
+	    for (b = 0; b < bitmap->width / 4; ++b) {
+		v = s[b];
+		*d++ = carry | (v >> (2 * shift));
+		carry = v << (8 - 2 * shift);
+	    }
+	    *d++ = carry;
+	}
+
+    /* return success */
+    return 1;
+}
+
+/**
+ * Set the limit on memory used by pre-shifted copies.
+ * @param limit is the maximum number of bytes to use.
+ */
+void bit_shiftlimit (long limit)
+{
+    shift_limit = limit;
+}
+
+/**
+ * Report the memory used by pre-shifted copies.
+ * @returns the number of bytes in use.
+ */
+long bit_shiftmemory (void)
+{
+    return shift_memory;
+}
+
+/**
+ * Make sure a bitmap's pixels are not shared before writing to them.
+ * @param bitmap is the bitmap about to be written to.
+ * @returns 1 on success, 0 if the bitmap is paged or there was not
+ * enough memory.
+ */
+int bit_own (Bitmap *bitmap)
+{
+    /* local variables */
+    struct pixelblock *block; /* the new block of pixels */
+    long size; /* size of the new block */
+
+    /* paged bitmaps can only be drawn on through views of a page */
+    if (bitmap->pages)
+	return 0;
+
+    /* pixels that no other bitmap uses can be written directly */
+    if (! bitmap->shared || bitmap->shared->users == 1)
+	return 1;
+
+    /* a bitmap's own memory is used again once no copy is using it */
+    if (bitmap->home && ! bitmap->home->users) {
+	release (go_home (bitmap), 1);
+	return 1;
+    }
+
+    /* reserve a block for the pixels, with its details at the start */
+    size = sizeof (struct pixelblock)
+	+ (long) bitmap->stride * bitmap->height;
+    if (size != (long) (size_t) size
+	|| ! (block = mem_alloc (bitmap->allocator, (size_t) size)))
+	return 0;
+    block->refs = 1;
+    block->users = 1;
+    block->block = block;
+    block->size = size;
+    block->allocator = bitmap->allocator;
+    if (! block->allocator)
+	mem_account (MEM_BITMAP, size, 0);
+
+    /* copy the pixels and stop sharing the old ones */
+    memcpy (block + 1, bitmap->pixels, (size_t) size
+	    - sizeof (struct pixelblock));
+    release (bitmap->shared, 1);
+    bitmap->shared = block;
+    bitmap->pixels = (char *) (block + 1);
+    return 1;
+}
+
 /**
  * Destroy a bitmap.
  * @param bitmap is the bitmap to destroy.
  */
 void bit_destroy (Bitmap *bitmap)
 {
+    /* local variables */
+    int p; /* page counter */
+
     if (bitmap) {
-        if (bitmap->pixels)
-            free (bitmap->pixels);
-        free (bitmap);
+	REC_DESTROY (bitmap);
+	if (! bitmap->allocator)
+	    mem_account (MEM_BITMAP, - heap_size (bitmap), -1);
+	if (bitmap->parent)
+	    --bitmap->parent->views;
+	if (bitmap->pages) {
+	    for (p = 0; p * bitmap->pagerows < bitmap->height; ++p)
+		free (bitmap->pages[p]);
+	    free (bitmap->pages);
+	}
+	if (bitmap->shifts) {
+	    free (bitmap->shifts);
+	    shift_memory -= shift_size (bitmap);
+	    mem_account (MEM_CACHE, - shift_size (bitmap), -1);
+	}
+	if (bitmap->shared)
+	    release (bitmap->shared, 1);
+	bitmap->shared = NULL;
+	if (bitmap->home)
+	    release (bitmap->home, 0);
+	else
+	    mem_free (bitmap->allocator, bitmap);
     }
 }
@@ -0,0 +1,217 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Compiled Sprite Module.
+ *
+ * Converts a sprite and its mask into a list of runs, so that fully
+ * transparent bytes can be skipped and fully opaque ones copied
+ * without masking when the sprite is drawn.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Classify a byte of a sprite by its mask.
+ * @param m is the mask byte.
+ * @returns 0 if opaque, 1 if partly transparent, 2 if transparent.
+ */
+static int classify (char m)
+{
+    if (m == 0)
+	return 0;
+    else if ((unsigned char) m == 0xff)
+	return 2;
+    else
+	return 1;
+}
+
+/**
+ * Scan a sprite and its mask for runs, optionally storing them.
+ * @param compiled is the compiled sprite, whose arrays may be NULL.
+ * @param sprite is the sprite bitmap.
+ * @param mask is the mask bitmap.
+ * @returns the number of data bytes needed.
+ */
+static int scan (Compiled *compiled, Bitmap *sprite, Bitmap *mask)
+{
+    /* local variables */
+    struct compiledrun *run; /* current run */
+    char *s; /* sprite row */
+    char *m; /* mask row */
+    char *d; /* data pointer */
+    int bytes; /* data bytes counted */
+    int r; /* row counter */
+    int b; /* byte counter */
+    int type; /* class of current byte */
+    int last; /* class of previous byte */
+
+    /* scan each row */
+    compiled->count = 0;
+    compiled->masked = 0;
+    bytes = 0;
+    run = NULL;
+    d = compiled->data;
+    for (r = 0; r < sprite->height; ++r) {
+	s = sprite->pixels + sprite->stride * r;
+	m = mask->pixels + mask->stride * r;
+	last = 2;
+	for (b = 0; b < sprite->width / 4; ++b) {
+
+	    /* transparent bytes are skipped altogether */
+	    type = classify (m[b]);
+	    if (type == 2) {
+		last = type;
+		continue;
+	    }
+
+	    /* start a new run if this byte can't join the last */
+	    if (type != last && compiled->runs) {
+		run = compiled->runs + compiled->count;
+		run->row = r;
+		run->offset = b;
+		run->length = 0;
+		run->masked = type;
+	    }
+	    if (type != last)
+		++compiled->count;
+	    last = type;
+
+	    /* store the byte, with its mask if partly transparent */
+	    if (compiled->runs) {
+		++run->length;
+		if (type)
+		    *d++ = m[b];
+		*d++ = s[b] & ~m[b];
+	    }
+	    bytes += type ? 2 : 1;
+	    compiled->masked += type;
+	}
+    }
+    return bytes;
+}
+
+/*----------------------------------------------------------------------
+ * Internal Level Functions.
+ */
+
+/**
+ * Put one run of a compiled sprite, clipped to a range of bytes on
+ * its row and to a clip region.
+ * @param run is the run to put.
+ * @param d is the address of the first byte of the destination row.
+ * @param s is the address of the run's data.
+ * @param b is the byte offset of the sprite on the destination row.
+ * @param y is the destination row.
+ * @param a is the first byte that may be drawn.
+ * @param e is the byte after the last that may be drawn.
+ * @param region is the clip region, or NULL for none.
+ * @returns the number of bytes put.
+ */
+int cpl_putrun (struct compiledrun *run, char far *d, char *s, int b,
+		int y, int a, int e, ClipRegion *region)
+{
+    /* local variables */
+    int i; /* span counter */
+    int pa; /* first byte of the current piece */
+    int pe; /* byte after the current piece */
+    int k; /* byte counter */
+    int put; /* number of bytes put */
+
+    /* trim the run to the bytes that may be drawn */
+    b += run->offset;
+    if (a < b)
+	a = b;
+    if (e > b + run->length)
+	e = b + run->length;
+    if (e <= a)
+	return 0;
+
+    /* put each piece of it that lies within the region */
+    put = 0;
+    for (i = 0; rgn_next (region, y, a, e - a, &i, &pa, &pe); ) {
+	if (! run->masked)
+	    _fmemcpy (d + pa, s + pa - b, pe - pa);
+	else
+	    for (k = pa; k < pe; ++k)
+		d[k] = (d[k] & s[2 * (k - b)]) | s[2 * (k - b) + 1];
+	put += pe - pa;
+    }
+    return put;
+}
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Compile a sprite and its mask into a list of runs.
+ * @param sprite is the sprite bitmap.
+ * @param mask is the mask, colour 3 where the sprite is transparent.
+ * @returns the new compiled sprite.
+ */
+Compiled *cpl_create (Bitmap *sprite, Bitmap *mask)
+{
+    /* local variables */
+    Compiled *compiled; /* the compiled sprite to return */
+    int bytes; /* number of data bytes */
+
+    /* count the runs and data needed */
+    if (! (compiled = malloc (sizeof (Compiled))))
+	return NULL;
+    compiled->width = sprite->width;
+    compiled->height = sprite->height;
+    compiled->runs = NULL;
+    compiled->data = NULL;
+    bytes = scan (compiled, sprite, mask);
+    compiled->size = bytes;
+
+    /* reserve memory for them */
+    if (! (compiled->runs = malloc
+	   ((compiled->count ? compiled->count : 1)
+	    * sizeof (struct compiledrun)))) {
+	free (compiled);
+	return NULL;
+    }
+    if (! (compiled->data = malloc (bytes ? bytes : 1))) {
+	free (compiled->runs);
+	free (compiled);
+	return NULL;
+    }
+
+    /* store the runs and return the compiled sprite */
+    scan (compiled, sprite, mask);
+    mem_account (MEM_OTHER, sizeof (Compiled) + compiled->size
+		 + (long) compiled->count * sizeof (struct compiledrun), 1);
+    return compiled;
+}
+
+/**
+ * Destroy a compiled sprite.
+ * @param compiled is the compiled sprite to destroy.
+ */
+void cpl_destroy (Compiled *compiled)
+{
+    if (compiled) {
+	mem_account (MEM_OTHER, - (long) sizeof (Compiled) - compiled->size
+		     - (long) compiled->count * sizeof (struct compiledrun),
+		     -1);
+	if (compiled->runs)
+	    free (compiled->runs);
+	if (compiled->data)
+	    free (compiled->data);
+	free (compiled);
+    }
+}
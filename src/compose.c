@@ -0,0 +1,507 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Compositor Module.
+ *
+ * Builds an area of the screen from a stack of layer bitmaps, such as
+ * a background, a playfield, sprites and a status panel. The area is
+ * divided into cells, and each layer keeps a note of which of its
+ * cells have changed. Only those cells are combined and put on the
+ * screen, and the layers beneath a cell that an upper layer covers
+ * completely are not drawn at all.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* the size of a cell in pixels */
+#define CMP_CELLW 8
+#define CMP_CELLH 8
+
+/* what a layer shows in a cell */
+#define CELL_EMPTY 0
+#define CELL_PARTIAL 1
+#define CELL_OPAQUE 2
+
+/*----------------------------------------------------------------------
+ * Level 2 Functions.
+ */
+
+/**
+ * Work out what a layer shows in an area.
+ * @param layer is the layer.
+ * @param x is the x coordinate of the area.
+ * @param y is the y coordinate of the area.
+ * @param w is the width of the area.
+ * @param h is the height of the area.
+ * @returns CELL_EMPTY if the layers below show through everywhere,
+ * CELL_OPAQUE if they show through nowhere, otherwise CELL_PARTIAL.
+ */
+static int cell_state (struct complayer *layer, int x, int y, int w,
+		       int h)
+{
+    /* local variables */
+    unsigned char *image; /* row of the image */
+    unsigned char *mask; /* row of the mask */
+    int opaque; /* 1 while no pixel shows through */
+    int empty; /* 1 while every pixel shows through */
+    int r; /* row counter */
+    int b; /* byte counter */
+    int m; /* the pixels of a byte that are not colour 0 */
+
+    /* an opaque layer hides everything beneath it */
+    if (layer->mode == CMP_OPAQUE)
+	return CELL_OPAQUE;
+
+    /* check each byte until the area is known to be partial */
+    opaque = empty = 1;
+    for (r = y; r < y + h && (opaque || empty); ++r) {
+	image = (unsigned char *) bit_row (layer->image, r);
+	if (layer->mode == CMP_KEYED)
+	    for (b = x / 4; b < (x + w) / 4; ++b) {
+		m = (image[b] | (image[b] >> 1)) & 0x55;
+		if (m != 0x55)
+		    opaque = 0;
+		if (m)
+		    empty = 0;
+	    }
+	else {
+	    mask = (unsigned char *) bit_row (layer->mask, r);
+	    for (b = x / 4; b < (x + w) / 4; ++b) {
+		if (mask[b])
+		    opaque = 0;
+		if (mask[b] != 0xff || image[b])
+		    empty = 0;
+	    }
+	}
+    }
+
+    /* return the state */
+    if (opaque)
+	return CELL_OPAQUE;
+    else if (empty)
+	return CELL_EMPTY;
+    return CELL_PARTIAL;
+}
+
+/**
+ * Make a mask for part of a CMP_KEYED layer, with colour 0 clear.
+ * @param compositor is the compositor.
+ * @param layer is the layer.
+ * @param x is the x coordinate of the part.
+ * @param y is the y coordinate of the part.
+ * @param w is the width of the part.
+ * @param h is the height of the part.
+ */
+static void make_keymask (Compositor *compositor, struct complayer *layer,
+			  int x, int y, int w, int h)
+{
+    /* local variables */
+    unsigned char *image; /* row of the image */
+    unsigned char *mask; /* row of the mask */
+    int r; /* row counter */
+    int b; /* byte counter */
+    int m; /* the pixels of a byte that are not colour 0 */
+
+    for (r = 0; r < h; ++r) {
+	image = (unsigned char *) bit_row (layer->image, y + r);
+	mask = (unsigned char *) bit_row (compositor->keymask, r);
+	for (b = x / 4; b < (x + w) / 4; ++b) {
+	    m = (image[b] | (image[b] >> 1)) & 0x55;
+	    mask[b] = (unsigned char) ~(m | (m << 1));
+	}
+    }
+}
+
+/**
+ * Work out which layers to draw in a cell, if it needs composing.
+ * @param compositor is the compositor.
+ * @param c is the number of the cell.
+ * @returns a bit for each layer to draw, or 0 if the cell is unchanged.
+ * The lowest layer to draw covers the cell completely, or is the lowest
+ * visible layer.
+ */
+static unsigned int cell_layers (Compositor *compositor, int c)
+{
+    /* local variables */
+    struct complayer *layer; /* the layer being checked */
+    unsigned int draw; /* the layers to draw */
+    int changed; /* 1 if a layer not covered over has changed */
+    int base; /* the lowest visible layer so far, or -1 */
+    int l; /* layer counter */
+
+    /* work down from the top until a layer covers the cell */
+    draw = 0;
+    changed = 0;
+    base = -1;
+    for (l = compositor->count - 1; l >= 0; --l) {
+	layer = &compositor->layers[l];
+	if (layer->dirty[c])
+	    changed = 1;
+	if (! layer->visible)
+	    continue;
+	base = l;
+	if (layer->state[c] != CELL_EMPTY)
+	    draw |= 1U << l;
+	if (layer->state[c] == CELL_OPAQUE)
+	    break;
+    }
+
+    /* the lowest layer is drawn whole, if anything has changed */
+    if (! changed || base < 0)
+	return 0;
+    return draw | (1U << base);
+}
+
+/**
+ * Compose a run of cells and put it on the screen.
+ * @param compositor is the compositor.
+ * @param x is the x coordinate of the run.
+ * @param y is the y coordinate of the run.
+ * @param w is the width of the run.
+ * @param h is the height of the run.
+ * @param draw is a bit for each layer to draw.
+ */
+static void compose (Compositor *compositor, int x, int y, int w, int h,
+		     unsigned int draw)
+{
+    /* local variables */
+    struct complayer *layer; /* the layer being drawn */
+    Bitmap *band; /* the row of cells to combine the layers in */
+    int base; /* the lowest layer to draw */
+    int l; /* layer counter */
+
+    /* find the lowest layer; if it's the only one, put it directly */
+    for (base = 0; ! (draw & (1U << base)); ++base);
+    layer = &compositor->layers[base];
+    if (draw == 1U << base) {
+	scr_putpart (compositor->screen, layer->image, compositor->x + x,
+		     compositor->y + y, x, y, w, h, DRAW_PSET);
+	return;
+    }
+
+    /* otherwise combine the layers in the band, from the bottom up */
+    band = compositor->band;
+    bit_putpart (band, layer->image, x, 0, x, y, w, h, DRAW_PSET);
+    for (l = base + 1; l < compositor->count; ++l)
+	if (draw & (1U << l)) {
+	    layer = &compositor->layers[l];
+	    if (layer->mode == CMP_KEYED) {
+		make_keymask (compositor, layer, x, y, w, h);
+		bit_putpart (band, compositor->keymask, x, 0, x, 0, w, h,
+			     DRAW_AND);
+	    } else
+		bit_putpart (band, layer->mask, x, 0, x, y, w, h, DRAW_AND);
+	    bit_putpart (band, layer->image, x, 0, x, y, w, h, DRAW_OR);
+	}
+    scr_putpart (compositor->screen, band, compositor->x + x,
+		 compositor->y + y, x, 0, w, h, DRAW_PSET);
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Mark every cell of a layer as changed.
+ * @param compositor is the compositor.
+ * @param layer is the layer.
+ */
+static void dirty_all (Compositor *compositor, struct complayer *layer)
+{
+    memset (layer->dirty, 1, compositor->cols * compositor->rows);
+    memset (layer->rows, 1, compositor->rows);
+}
+
+/**
+ * Compose and present the changed cells in a row of cells.
+ * @param compositor is the compositor.
+ * @param row is the row of cells.
+ * @returns the number of cells put on the screen.
+ */
+static int update_row (Compositor *compositor, int row)
+{
+    /* local variables */
+    struct complayer *layer; /* the layer being checked */
+    unsigned int *draw; /* the layers to draw in each cell */
+    int c; /* number of the first cell in the row */
+    int l; /* layer counter */
+    int x; /* cell counter */
+    int e; /* cell at the end of a run */
+    int y; /* y coordinate of the row */
+    int w; /* width of a cell or run */
+    int h; /* height of the row */
+    int count; /* number of cells put */
+
+    /* work out the row's position */
+    c = row * compositor->cols;
+    y = row * CMP_CELLH;
+    h = (compositor->height - y < CMP_CELLH)
+	? compositor->height - y : CMP_CELLH;
+
+    /* work out afresh what each layer shows in its changed cells */
+    for (l = 0; l < compositor->count; ++l) {
+	layer = &compositor->layers[l];
+	if (layer->rows[row])
+	    for (x = 0; x < compositor->cols; ++x)
+		if (layer->dirty[c + x]) {
+		    w = (compositor->width - x * CMP_CELLW < CMP_CELLW)
+			? compositor->width - x * CMP_CELLW : CMP_CELLW;
+		    layer->state[c + x] = cell_state (layer, x * CMP_CELLW,
+						      y, w, h);
+		}
+    }
+
+    /* decide which cells need composing, and from which layers */
+    draw = compositor->draw;
+    for (x = 0; x < compositor->cols; ++x)
+	draw[x] = cell_layers (compositor, c + x);
+
+    /* compose each run of cells that have the same layers to draw */
+    count = 0;
+    x = 0;
+    while (x < compositor->cols)
+	if (! draw[x])
+	    ++x;
+	else {
+	    for (e = x + 1; e < compositor->cols && draw[e] == draw[x];
+		 ++e);
+	    w = ((e * CMP_CELLW < compositor->width)
+		 ? e * CMP_CELLW : compositor->width) - x * CMP_CELLW;
+	    compose (compositor, x * CMP_CELLW, y, w, h, draw[x]);
+	    count += e - x;
+	    x = e;
+	}
+
+    /* the layers are now up to date in this row */
+    for (l = 0; l < compositor->count; ++l) {
+	layer = &compositor->layers[l];
+	if (layer->rows[row]) {
+	    memset (layer->dirty + c, 0, compositor->cols);
+	    layer->rows[row] = 0;
+	}
+    }
+    return count;
+}
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Create a compositor for an area of the screen.
+ * @param screen is the screen to show the layers on.
+ * @param x is the x coordinate of the area on the screen.
+ * @param y is the y coordinate of the area on the screen.
+ * @param width is the width of the area.
+ * @param height is the height of the area.
+ * @returns the new compositor.
+ */
+Compositor *cmp_create (Screen *screen, int x, int y, int width,
+			int height)
+{
+    /* local variables */
+    Compositor *compositor; /* the compositor to return */
+    int cols; /* number of cells across the area */
+
+    /* reserve memory */
+    cols = (width + CMP_CELLW - 1) / CMP_CELLW;
+    if (! (compositor = malloc (sizeof (Compositor))))
+	return NULL;
+    if (! (compositor->draw = malloc (cols * sizeof (unsigned int)))) {
+	free (compositor);
+	return NULL;
+    }
+    compositor->band = bit_create (width, CMP_CELLH);
+    compositor->keymask = bit_create (width, CMP_CELLH);
+    if (! compositor->band || ! compositor->keymask) {
+	if (compositor->band)
+	    bit_destroy (compositor->band);
+	if (compositor->keymask)
+	    bit_destroy (compositor->keymask);
+	free (compositor->draw);
+	free (compositor);
+	return NULL;
+    }
+    mem_account (MEM_OTHER, sizeof (Compositor)
+		 + cols * sizeof (unsigned int), 1);
+
+    /* initialise the compositor with no layers */
+    compositor->screen = screen;
+    compositor->x = x;
+    compositor->y = y;
+    compositor->width = width;
+    compositor->height = height;
+    compositor->cols = cols;
+    compositor->rows = (height + CMP_CELLH - 1) / CMP_CELLH;
+    compositor->count = 0;
+
+    /* return the compositor */
+    return compositor;
+}
+
+/**
+ * Add a layer above the others.
+ * @param compositor is the compositor to add the layer to.
+ * @param image is the bitmap shown in the layer.
+ * @param mask is the mask for CMP_MASKED, or NULL.
+ * @param mode is how the layer lets the layers below show through.
+ * @returns the number of the layer, or -1 on failure.
+ */
+int cmp_addlayer (Compositor *compositor, Bitmap *image, Bitmap *mask,
+		  LayerMode mode)
+{
+    /* local variables */
+    struct complayer *layer; /* the new layer */
+    int cells; /* number of cells in the area */
+
+    /* check that there's room, and that the bitmaps cover the area */
+    if (compositor->count == CMP_LAYERS
+	|| image->width < compositor->width
+	|| image->height < compositor->height
+	|| (mode == CMP_MASKED
+	    && (! mask || mask->width < compositor->width
+		|| mask->height < compositor->height)))
+	return -1;
+
+    /* reserve memory for the notes on each cell */
+    layer = &compositor->layers[compositor->count];
+    cells = compositor->cols * compositor->rows;
+    if (! (layer->dirty = malloc (2 * cells + compositor->rows)))
+	return -1;
+    mem_account (MEM_OTHER, 2 * cells + compositor->rows, 1);
+    layer->state = layer->dirty + cells;
+    layer->rows = layer->state + cells;
+
+    /* initialise the layer, to be drawn in full at the next update */
+    layer->image = image;
+    layer->mask = (mode == CMP_MASKED) ? mask : NULL;
+    layer->mode = mode;
+    layer->visible = 1;
+    dirty_all (compositor, layer);
+    return compositor->count++;
+}
+
+/**
+ * Mark an area of a layer as changed.
+ * @param compositor is the compositor.
+ * @param layer is the number of the layer.
+ * @param x is the x coordinate of the area.
+ * @param y is the y coordinate of the area.
+ * @param width is the width of the area.
+ * @param height is the height of the area.
+ */
+void cmp_dirty (Compositor *compositor, int layer, int x, int y,
+		int width, int height)
+{
+    /* local variables */
+    struct complayer *l; /* the layer */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+    int cx; /* cell column counter */
+    int cy; /* cell row counter */
+
+    /* keep the area within the compositor */
+    if (layer < 0 || layer >= compositor->count)
+	return;
+    xs = ys = 0;
+    if (! bit_cliprect (&x, &y, &xs, &ys, &width, &height, 0, 0,
+			compositor->width, compositor->height))
+	return;
+
+    /* mark each cell that the area touches */
+    l = &compositor->layers[layer];
+    for (cy = y / CMP_CELLH; cy <= (y + height - 1) / CMP_CELLH; ++cy) {
+	l->rows[cy] = 1;
+	for (cx = x / CMP_CELLW; cx <= (x + width - 1) / CMP_CELLW; ++cx)
+	    l->dirty[cy * compositor->cols + cx] = 1;
+    }
+}
+
+/**
+ * Show or hide a layer.
+ * @param compositor is the compositor.
+ * @param layer is the number of the layer.
+ * @param visible is 1 to show the layer, 0 to hide it.
+ */
+void cmp_show (Compositor *compositor, int layer, int visible)
+{
+    if (layer >= 0 && layer < compositor->count
+	&& visible != compositor->layers[layer].visible) {
+	compositor->layers[layer].visible = visible;
+	dirty_all (compositor, &compositor->layers[layer]);
+    }
+}
+
+/**
+ * Mark the whole area to be composed and presented again.
+ * @param compositor is the compositor.
+ */
+void cmp_refresh (Compositor *compositor)
+{
+    /* local variables */
+    int l; /* layer counter */
+
+    for (l = 0; l < compositor->count; ++l)
+	dirty_all (compositor, &compositor->layers[l]);
+}
+
+/**
+ * Compose the changed cells and put them on the screen.
+ * @param compositor is the compositor.
+ * @returns the number of cells put on the screen.
+ */
+int cmp_update (Compositor *compositor)
+{
+    /* local variables */
+    int row; /* row of cells */
+    int l; /* layer counter */
+    int count; /* number of cells put */
+
+    /* update the rows in which any layer has changed */
+    count = 0;
+    for (row = 0; row < compositor->rows; ++row) {
+	for (l = 0; l < compositor->count; ++l)
+	    if (compositor->layers[l].rows[row])
+		break;
+	if (l < compositor->count)
+	    count += update_row (compositor, row);
+    }
+    return count;
+}
+
+/**
+ * Destroy a compositor. The layer bitmaps are left alone.
+ * @param compositor is the compositor to destroy.
+ */
+void cmp_destroy (Compositor *compositor)
+{
+    /* local variables */
+    int l; /* layer counter */
+    int cells; /* number of cells in the area */
+
+    cells = compositor->cols * compositor->rows;
+    for (l = 0; l < compositor->count; ++l) {
+	free (compositor->layers[l].dirty);
+	mem_account (MEM_OTHER, - (long) (2 * cells + compositor->rows),
+		     -1);
+    }
+    bit_destroy (compositor->band);
+    bit_destroy (compositor->keymask);
+    free (compositor->draw);
+    mem_account (MEM_OTHER, - (long) sizeof (Compositor)
+		 - (long) (compositor->cols * sizeof (unsigned int)), -1);
+    free (compositor);
+}
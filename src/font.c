@@ -20,32 +20,46 @@
  */
 
 /**
- * Create a new font.
+ * Create a new font using a particular allocator.
+ * @param allocator is the arena or pool, or NULL for the heap.
  * @param first is the first character in the font.
  * @param last is the last character in the font.
  * @returns the new font.
  */
-Font *fnt_create (int first, int last)
+Font *fnt_createin (Allocator *allocator, int first, int last)
 {
     /* local variables */
     Font *font; /* the font to return */
+    size_t size; /* size of the font and its pixels */
 
-    /* attempt to allocate memory */
-    if (! (font = malloc (sizeof (Font))))
-        return NULL;
-    if (! (font->pixels = malloc (8 * (last - first + 1)))) {
-        free (font);
+    /* attempt to allocate memory for the font and its pixels */
+    size = sizeof (Font) + 8 * (last - first + 1);
+    if (! (font = mem_alloc (allocator, size)))
         return NULL;
-    }
+    if (! allocator)
+	mem_account (MEM_FONT, size, 1);
 
     /* set the font information */
     font->first = first;
     font->last = last;
+    font->pixels = (char *) (font + 1);
+    font->allocator = allocator;
 
     /* return the font */
     return font;
 }
 
+/**
+ * Create a new font.
+ * @param first is the first character in the font.
+ * @param last is the last character in the font.
+ * @returns the new font.
+ */
+Font *fnt_create (int first, int last)
+{
+    return fnt_createin (mem_installed (), first, last);
+}
+
 /**
  * Copy a font.
  * @param font is the font to copy.
@@ -57,16 +71,10 @@ Font *fnt_copy (Font *src)
     Font *dst; /* destination font */
 
     /* attempt to reserve memory */
-    if (! (dst = malloc (sizeof (Font))))
-        return NULL;
-    if (! (dst->pixels = malloc (8 * (src->last - src->first + 1)))) {
-        free (dst);
+    if (! (dst = fnt_create (src->first, src->last)))
         return NULL;
-    }
 
-    /* set the font information */
-    dst->first = src->first;
-    dst->last = src->last;
+    /* copy the pixels */
     memcpy (dst->pixels, src->pixels, 8 * (src->last - src->first + 1));
 
     /* return the font */
@@ -92,24 +100,15 @@ Font *fnt_read (FILE *input)
         return NULL;
 
     /* attempt to allocate memory */
-    if (! (font = malloc (sizeof (Font))))
-        return NULL;
-    if (! (font->pixels = malloc (8 * (l - f + 1)))) {
-        free (font);
+    if (! (font = fnt_create (f, l)))
         return NULL;
-    }
 
     /* attempt to read the pixel data */
     if (! fread (font->pixels, 8 * (l - f + 1), 1, input)) {
-        free (font->pixels);
-        free (font);
+        fnt_destroy (font);
         return NULL;
     }
 
-    /* set the other font information */
-    font->first = f;
-    font->last = l;
-
     /* return the font */
     return font;
 }
@@ -138,7 +137,15 @@ void fnt_write (Font *font, FILE *output)
  */
 void fnt_put (Font *dst, Bitmap *src, int ch)
 {
-    memcpy (dst->pixels + 8 * (ch - dst->first), src->pixels, 8);
+    /* local variables */
+    int r; /* row counter */
+
+    /* copy each row, as the bitmap may be a view */
+    PRF_CALL (PRF_FNT_PUT, DRAW_PSET, dst);
+    PRF_BYTES (PRF_FNT_PUT, DRAW_PSET, 0, 0L, 8L);
+    for (r = 0; r < 8; ++r)
+	dst->pixels[8 * (ch - dst->first) + r] = src->pixels[src->stride * r];
+    PRF_END (PRF_FNT_PUT);
 }
 
 /**
@@ -149,7 +156,20 @@ void fnt_put (Font *dst, Bitmap *src, int ch)
  */
 void fnt_get (Font *src, Bitmap *dst, int ch)
 {
-    memcpy (dst->pixels, src->pixels + 8 * (ch - src->first), 8);
+    /* local variables */
+    int r; /* row counter */
+
+    /* copy each row, as the bitmap may be a view */
+    PRF_CALL (PRF_FNT_GET, DRAW_PSET, src);
+    if (! bit_own (dst)) {
+	PRF_END (PRF_FNT_GET);
+	return;
+    }
+    PRF_BYTES (PRF_FNT_GET, DRAW_PSET, 0, 8L, 0L);
+    for (r = 0; r < 8; ++r)
+	dst->pixels[dst->stride * r] = src->pixels[8 * (ch - src->first) + r];
+    REC_LOAD (dst);
+    PRF_END (PRF_FNT_GET);
 }
 
 /**
@@ -195,8 +215,9 @@ void fnt_colours (Font *font, int ink, int paper)
 void fnt_destroy (Font *font)
 {
     if (font) {
-        if (font->pixels)
-            free (font->pixels);
-        free (font);
+	if (! font->allocator)
+	    mem_account (MEM_FONT, - (long) (sizeof (Font)
+			 + 8 * (font->last - font->first + 1)), -1);
+        mem_free (font->allocator, font);
     }
 }
@@ -0,0 +1,532 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Game Module.
+ *
+ * The Droids game played by the demonstration program and the autoplay
+ * benchmark. All of a game's state is kept in a Game structure, and
+ * its random numbers are its own, so that a game started with the same
+ * seed and given the same keys is always played the same way, and
+ * several games can be played at once on different screens.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* project headers */
+#include "cgalib.h"
+#include "game.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* the most droids there is always room for, away from the player */
+#define MAX_DROIDS 80
+
+/*----------------------------------------------------------------------
+ * Level 3 Functions.
+ */
+
+/**
+ * Return a random number from the game's own sequence.
+ * @param game is the game.
+ * @param n is the number of possible values.
+ * @returns a number from 0 to n - 1.
+ */
+static int random_number (Game *game, int n)
+{
+    game->seed = (game->seed * 25173U + 13849U) & 0xffff;
+    return (game->seed >> 8) % n;
+}
+
+/**
+ * Show the score.
+ * @param game is the game.
+ */
+static void display_score (Game *game)
+{
+    char scoreboard[6];
+    sprintf (scoreboard, "%05d", game->score);
+    scr_print (game->screen, 300, 192, scoreboard);
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Functions.
+ */
+
+/**
+ * Move the player.
+ * @param game is the game.
+ * @returns 1 if the level is finished, 0 if not.
+ */
+static int move_player (Game *game)
+{
+    int finished, /* true if the player has won or died */
+	xd, /* calculated x direction */
+	yd, /* calculated y direction */
+	x, /* teleport x coordinate */
+	y, /* teleport y coordinate */
+	key; /* key pressed */
+
+    /* wait for a key */
+    finished = 0;
+    key = game->input (game, GAME_MOVE, game->data);
+    scr_ink (game->screen, 0);
+    scr_box (game->screen, 148, 192, 24, 8);
+    scr_ink (game->screen, 3);
+
+    /* determine vertical direction */
+    if (key == -71 || key == -72 || key == -73
+	|| key == '7' || key == '8' || key == '9'
+	|| key == 'q' || key == 'w' || key == 'e'
+	|| key == 'Q' || key == 'W' || key == 'E')
+	yd = -1;
+    else if (key == -79 || key == -80 || key == -81
+	|| key == '1' || key == '2' || key == '3'
+	|| key == 'z' || key == 'x' || key == 'c'
+	|| key == 'Z' || key == 'X' || key == 'C'
+	|| key == 's' || key == 'S')
+	yd = 1;
+    else
+	yd = 0;
+
+    /* determine horizontal direction */
+    if (key == -71 || key == -75 || key == -79
+	|| key == '7' || key == '4' || key == '1'
+	|| key == 'q' || key == 'a' || key == 'z'
+	|| key == 'Q' || key == 'A' || key == 'Z')
+	xd = -1;
+    else if (key == -73 || key == -77 || key == -81
+	|| key == '9' || key == '6' || key == '3'
+	|| key == 'e' || key == 'd' || key == 'c'
+	|| key == 'E' || key == 'D' || key == 'C')
+	xd = 1;
+    else
+	xd = 0;
+
+    /* move the player */
+    if ((xd || yd)
+	&& game->player_x + xd >= 0 && game->player_x + xd <= 17
+	&& game->player_y + yd >= 0 && game->player_y + yd <= 9) {
+	game->map[game->player_x][game->player_y] = 0;
+	bit_put (game->map_img, game->bit[0], 16 * game->player_x,
+		 16 * game->player_y, DRAW_PSET);
+	if (game->map[game->player_x + xd][game->player_y + yd] == 0) {
+	    game->map[game->player_x + xd][game->player_y + yd] = 1;
+	    bit_put (game->map_img, game->bit[2],
+		     16 * (game->player_x + xd), 16 * (game->player_y + yd),
+		     DRAW_AND);
+	    bit_put (game->map_img, game->bit[1],
+		     16 * (game->player_x + xd), 16 * (game->player_y + yd),
+		     DRAW_OR);
+	    game->player_x += xd;
+	    game->player_y += yd;
+	    scr_put (game->screen, game->map_img, 16, 16, DRAW_PSET);
+	} else
+	    scr_print (game->screen, 148, 192, "OUCH!!");
+    }
+
+    /* player tried to move into a wall */
+    else if (xd || yd)
+	scr_print (game->screen, 148, 192, "OUCH!!");
+
+    /* teleport the player */
+    else if (key == 32) {
+
+	/* find an empty place */
+	do {
+	    x = random_number (game, 18);
+	    y = random_number (game, 10);
+	} while (game->map[x][y]);
+
+	/* move the player there */
+	game->map[game->player_x][game->player_y] = 0;
+	game->map[x][y] = 1;
+	bit_put (game->map_img, game->bit[0], 16 * game->player_x,
+		 16 * game->player_y, DRAW_PSET);
+	bit_put (game->map_img, game->bit[2], 16 * x, 16 * y, DRAW_AND);
+	bit_put (game->map_img, game->bit[1], 16 * x, 16 * y, DRAW_OR);
+	game->player_x = x;
+	game->player_y = y;
+	scr_put (game->screen, game->map_img, 16, 16, DRAW_PSET);
+
+	/* apply and display the score penalty */
+	game->score -= (game->score > game->droids / 2)
+	    ? game->droids / 2
+	    : game->score;
+	display_score (game);
+    }
+
+    /* return true if finished */
+    return finished;
+}
+
+/**
+ * Move the droids.
+ * @param game is the game.
+ * @returns 1 if the level is finished, 0 if not.
+ */
+static int move_droids (Game *game)
+{
+    /* local variables */
+    int x, y, xd, yd, c, finished, new_map[18][10];
+
+    /* initialise the new map */
+    for (x = 0; x < 18; ++x)
+	for (y = 0; y < 10; ++y)
+	    new_map[x][y] = game->map[x][y] * (game->map[x][y] != 3);
+
+    /* move all the robots on the map */
+    finished = 0;
+    for (x = 0; x < 18; ++x)
+	for (y = 0; y < 10; ++y)
+	    if (game->map[x][y] == 3) {
+
+		/* update the old position with whatever will be here */
+		bit_put (game->map_img, game->bit[0], 16 * x, 16 * y,
+			 DRAW_PSET);
+		bit_put (game->map_img, game->bit[new_map[x][y] + 1],
+			 16 * x, 16 * y, DRAW_AND);
+		bit_put (game->map_img, game->bit[new_map[x][y]], 16 * x,
+			 16 * y, DRAW_OR);
+
+		/* work out the direction of movement */
+		xd = (game->player_x > x) - (game->player_x < x);
+		yd = (game->player_y > y) - (game->player_y < y);
+
+		/* moving on to a blank square or the player */
+		if (new_map[x + xd][y + yd] == 0
+		    || new_map[x + xd][y + yd] == 1) {
+		    new_map[x + xd][y + yd] = 3;
+		    bit_put (game->map_img, game->bit[4], 16 * (x + xd),
+			     16 * (y + yd), DRAW_AND);
+		    bit_put (game->map_img, game->bit[3], 16 * (x + xd),
+			     16 * (y + yd), DRAW_OR);
+		    if (x + xd == game->player_x
+			&& y + yd == game->player_y)
+			finished = 1;
+		}
+
+		/* crashing into another droid */
+		else if (new_map[x + xd][y + yd] == 3) {
+		    new_map[x + xd][y + yd] = 5;
+		    bit_put (game->map_img, game->bit[6], 16 * (x + xd),
+			     16 * (y + yd), DRAW_AND);
+		    bit_put (game->map_img, game->bit[5], 16 * (x + xd),
+			     16 * (y + yd), DRAW_OR);
+		    game->score += 2;
+		}
+
+		/* crashing into debris */
+		else if (new_map[x + xd][y + yd] == 5)
+		    game->score += 1;
+	    }
+
+    /* copy the new map over the old one */
+    c = 0;
+    for (x = 0; x < 18; ++x)
+	for (y = 0; y < 10; ++y) {
+	    game->map[x][y] = new_map[x][y];
+	    c += (game->map[x][y] == 3);
+	}
+    if (!c)
+	finished = 1;
+
+    /* redraw the screen and return */
+    scr_put (game->screen, game->map_img, 16, 16, DRAW_PSET);
+    display_score (game);
+    return finished;
+}
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Load and validate a font.
+ * @param filename is the name of the font file.
+ * @returns the loaded font, or NULL on failure.
+ * The font file loaded by this function requires an 8-byte header,
+ * consisting of the text CGA100F and a null byte. Then follows two
+ * bytes determining the first and last character codes supported by
+ * the font. After that is the font pixel data.
+ */
+Font *game_loadfont (char *filename)
+{
+    /* local variables */
+    Font *font;
+    FILE *fp;
+    char header[8];
+
+    /* attempt to open the file, and read and verify the header */
+    if (! (fp = fopen (filename, "rb")))
+	return NULL;
+    else if (! fread (header, 8, 1, fp)) {
+	fclose (fp);
+	return NULL;
+    } else if (strcmp (header, "CGA100F")) {
+	fclose (fp);
+	return NULL;
+    }
+
+    /* read the font and return it */
+    font = fnt_read (fp);
+    fclose (fp);
+    return font;
+}
+
+/**
+ * Load the game's bitmaps.
+ * @param filename is the bitmap file.
+ * @param bit is the array of 16 bitmaps to fill.
+ * @returns 1 if successful, 0 on failure.
+ */
+int game_loadbitmaps (char *filename, Bitmap **bit)
+{
+    /* local variables */
+    FILE *fp;
+    char header[8];
+    int c;
+
+    /* attempt to open the file, and read and verify the header */
+    if (! (fp = fopen (filename, "rb")))
+	return 0;
+    else if (! fread (header, 8, 1, fp)) {
+	fclose (fp);
+	return 0;
+    } else if (strcmp (header, "CGA100B")) {
+	fclose (fp);
+	return 0;
+    }
+
+    /* read the sixteen bitmaps */
+    for (c = 0; c < 16; ++c)
+	bit[c] = bit_read (fp);
+    fclose (fp);
+    return 1;
+}
+
+/**
+ * Create a game.
+ * @param screen is the screen to draw the game on.
+ * @param font is the font for the messages and score.
+ * @param bit is the array of 16 bitmaps to draw the game with.
+ * @param seed is the seed for the game's random numbers.
+ * @param input is the function that supplies the keys.
+ * @param data is passed to the input function.
+ * @returns the new game, or NULL if out of memory.
+ */
+Game *game_create (Screen *screen, Font *font, Bitmap **bit,
+		   unsigned int seed, GameInput input, void *data)
+{
+    /* local variables */
+    Game *game; /* the game to return */
+
+    /* reserve memory for the game */
+    if (! (game = malloc (sizeof (Game))))
+	return NULL;
+
+    /* initialise the game */
+    game->screen = screen;
+    game->font = font;
+    game->bit = bit;
+    game->map_img = NULL;
+    game->player_x = game->player_y = 0;
+    game->droids = game->score = 0;
+    game->turns = 0;
+    game->seed = seed & 0xffff;
+    game->input = input;
+    game->data = data;
+    return game;
+}
+
+/**
+ * Start a new game, drawing the playing field.
+ * @param game is the game.
+ * @returns 1 if successful, 0 if out of memory.
+ */
+int game_start (Game *game)
+{
+    /* local variables */
+    Bitmap *hidden; /* hidden copy of the screen */
+    int x, y; /* X and Y game coordinates */
+    int walls[8] = {8, 8, 8, 8, 8, 8, 14, 15}; /* random wall pieces */
+
+    /* display please wait message */
+    scr_font (game->screen, game->font);
+    scr_print (game->screen, 132, 192, "Please wait...");
+
+    /* prepare the game field */
+    if (! (hidden = bit_create (320, 192)))
+	return 0;
+    bit_put (hidden, game->bit[7], 0, 0, DRAW_PSET);
+    bit_put (hidden, game->bit[9], 304, 0, DRAW_PSET);
+    bit_put (hidden, game->bit[12], 0, 176, DRAW_PSET);
+    bit_put (hidden, game->bit[13], 304, 176, DRAW_PSET);
+    for (x = 1; x < 19; ++x) {
+	bit_put (hidden, game->bit[walls[random_number (game, 8)]],
+		 16 * x, 0, DRAW_PSET);
+	bit_put (hidden, game->bit[walls[random_number (game, 8)]],
+		 16 * x, 176, DRAW_PSET);
+    }
+    for (y = 1; y < 11; ++y) {
+	bit_put (hidden, game->bit[10], 0, 16 * y, DRAW_PSET);
+	bit_put (hidden, game->bit[11], 304, 16 * y, DRAW_PSET);
+    }
+    bit_ink (hidden, 0);
+    bit_box (hidden, 16, 16, 288, 160);
+    scr_put (game->screen, hidden, 0, 0, DRAW_PSET);
+    bit_destroy (hidden);
+
+    /* create the map image */
+    if (! game->map_img && ! (game->map_img = bit_create (288, 160)))
+	return 0;
+
+    /* initialise score and such */
+    game->score = 0;
+    game->droids = 12;
+    return 1;
+}
+
+/**
+ * Set up a single play level.
+ * @param game is the game.
+ */
+void game_level (Game *game)
+{
+    /* local variables */
+    int x, y, /* temporary x and y coordinates */
+	c; /* counter for droids */
+
+    /* (re-)display please wait message */
+    scr_font (game->screen, game->font);
+    scr_print (game->screen, 132, 192, "Please wait...");
+
+    /* clear the map */
+    for (x = 0; x < 18; ++x)
+	for (y = 0; y < 10; ++y)
+	    game->map[x][y] = 0;
+
+    /* place the player */
+    game->player_x = random_number (game, 18);
+    game->player_y = random_number (game, 10);
+    game->map[game->player_x][game->player_y] = 1;
+
+    /* place the droids */
+    for (c = 0; c < game->droids; ++c) {
+	do {
+	    x = random_number (game, 18);
+	    y = random_number (game, 10);
+	} while (abs (x - game->player_x) + abs (y - game->player_y) < 8
+		 || game->map[x][y] != 0);
+	game->map[x][y] = 3;
+    }
+
+    /* prepare the game map */
+    for (x = 0; x < 18; ++x)
+	for (y = 0; y < 10; ++y) {
+	    bit_put (game->map_img, game->bit[0], 16 * x, 16 * y,
+		     DRAW_PSET);
+	    if (game->map[x][y]) {
+		bit_put (game->map_img, game->bit[game->map[x][y] + 1],
+			 x * 16, y * 16, DRAW_AND);
+		bit_put (game->map_img, game->bit[game->map[x][y]],
+			 x * 16, y * 16, DRAW_OR);
+	    }
+	}
+    scr_put (game->screen, game->map_img, 16, 16, DRAW_PSET);
+
+    /* clear the "please wait" message and display the score */
+    scr_ink (game->screen, 0);
+    scr_box (game->screen, 132, 192, 56, 8);
+    scr_ink (game->screen, 3);
+    display_score (game);
+}
+
+/**
+ * Play a turn, moving the player and then the droids.
+ * @param game is the game.
+ * @returns 1 if the level is finished, 0 if not.
+ */
+int game_turn (Game *game)
+{
+    int finished; /* true if the player has won or died */
+
+    /* move the player and the droids, and mark the turn in any log */
+    finished = move_player (game);
+    if (! finished)
+	finished = move_droids (game);
+    ++game->turns;
+    rec_frame ();
+    return finished;
+}
+
+/**
+ * Process the end of a level.
+ * @param game is the game.
+ * @returns 1 if the player is dead, 0 if the level was cleared.
+ */
+int game_endlevel (Game *game)
+{
+    /* display the victory or defeat message */
+    if (game->map[game->player_x][game->player_y] == 1)
+	scr_print (game->screen, 132, 192, "Level cleared!");
+    else
+	scr_print (game->screen, 128, 192, "You are defeated");
+    game->input (game, GAME_LEVEL, game->data);
+    scr_ink (game->screen, 0);
+    scr_box (game->screen, 128, 192, 64, 8);
+    scr_ink (game->screen, 3);
+    if (game->droids < MAX_DROIDS)
+	++game->droids;
+
+    /* return true if player is dead */
+    return game->map[game->player_x][game->player_y] != 1;
+}
+
+/**
+ * Process the end of a game.
+ * @param game is the game.
+ * @returns 1 if the player wants to quit, 0 to play again.
+ */
+int game_end (Game *game)
+{
+    /* local variables */
+    int key; /* key that the player pressed */
+
+    /* print the prompt, and get the key */
+    scr_print (game->screen, 124, 192, "Play again (Y/N) ?");
+    do {
+	key = game->input (game, GAME_AGAIN, game->data);
+    } while (key != 'Y' && key != 'y' && key != 'N' && key != 'n');
+    scr_ink (game->screen, 0);
+    scr_box (game->screen, 124, 192, 72, 8);
+    scr_ink (game->screen, 3);
+    bit_destroy (game->map_img);
+    game->map_img = NULL;
+
+    /* return true if key is 'N' to quit */
+    return (key == 'N' || key == 'n');
+}
+
+/**
+ * Destroy a game.
+ * @param game is the game.
+ */
+void game_destroy (Game *game)
+{
+    if (game) {
+	if (game->map_img)
+	    bit_destroy (game->map_img);
+	free (game);
+    }
+}
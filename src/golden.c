@@ -0,0 +1,799 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Golden Image Check.
+ *
+ * Draws a set of scenes onto a bitmap and onto screens in memory with
+ * the CGA and Hercules layouts, and compares a hash of each result
+ * with the hash recorded when the scene was known to be drawn
+ * correctly. Any picture that differs is written out as a PPM image.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* project headers */
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * File Level Variables.
+ */
+
+/** @var TARGETS is the number of targets each scene is drawn on. */
+#define TARGETS 3
+
+/** @var SCENES is the number of scenes. */
+#define SCENES 9
+
+/** @var targets are the names of the targets. */
+static char *targets[TARGETS] = {"bitmap", "cga", "hercules"};
+
+/** @var canvas is the bitmap target. */
+static Bitmap *canvas;
+
+/** @var scr is the screen being drawn on, or NULL for the canvas. */
+static Screen *scr;
+
+/** @var screens are the CGA and Hercules screen targets. */
+static Screen *screens[TARGETS - 1];
+
+/** @var borrowed is 1 while the canvas target borrows a screen. */
+static int borrowed;
+
+/** @var fonts are the three supplied fonts. */
+static Font *fonts[3];
+
+/** @var bit are the demonstration program's bitmaps. */
+static Bitmap *bit[16];
+
+/** @var sprite is a patterned sprite, pre-shifted. */
+static Bitmap *sprite;
+
+/** @var seed is the seed for the repeatable random numbers. */
+static unsigned int seed;
+
+/*----------------------------------------------------------------------
+ * Service Routines.
+ */
+
+/**
+ * Error Handler.
+ * @param errorlevel is the error level to return to the OS.
+ * @param message is the message to print.
+ */
+void error_handler (int errorlevel, char *message)
+{
+    puts (message);
+    exit (errorlevel);
+}
+
+/**
+ * Return a random number that is the same on any compiler.
+ * @param n is the number of possible values.
+ * @returns a number from 0 to n - 1.
+ */
+static int random_number (int n)
+{
+    seed = (seed * 25173U + 13849U) & 0xffff;
+    return (seed >> 8) % n;
+}
+
+/*----------------------------------------------------------------------
+ * Level 3 Routines.
+ */
+
+/* Drawing on the current target, which is a screen or the canvas */
+
+static void put (Bitmap *src, int x, int y, DrawMode draw)
+{
+    if (scr)
+	scr_put (scr, src, x, y, draw);
+    else
+	bit_put (canvas, src, x, y, draw);
+}
+
+static void putpart (Bitmap *src, int xd, int yd, int xs, int ys,
+		     int w, int h, DrawMode draw)
+{
+    if (scr)
+	scr_putpart (scr, src, xd, yd, xs, ys, w, h, draw);
+    else
+	bit_putpart (canvas, src, xd, yd, xs, ys, w, h, draw);
+}
+
+static void putcompiled (Compiled *src, int x, int y)
+{
+    if (scr)
+	scr_putcompiled (scr, src, x, y);
+    else
+	bit_putcompiled (canvas, src, x, y);
+}
+
+static void get (Bitmap *dst, int x, int y)
+{
+    if (scr)
+	scr_get (scr, dst, x, y);
+    else
+	bit_get (canvas, dst, x, y);
+}
+
+static void box (int x, int y, int w, int h)
+{
+    if (scr)
+	scr_box (scr, x, y, w, h);
+    else
+	bit_box (canvas, x, y, w, h);
+}
+
+static void scroll (int x, int y, int w, int h, int dx, int dy, int fill)
+{
+    if (scr)
+	scr_scroll (scr, x, y, w, h, dx, dy, fill);
+    else
+	bit_scroll (canvas, x, y, w, h, dx, dy, fill);
+}
+
+static void print (int x, int y, char *message)
+{
+    if (scr)
+	scr_print (scr, x, y, message);
+    else
+	bit_print (canvas, x, y, message);
+}
+
+static void colours (int ink, int paper)
+{
+    if (scr) {
+	scr_ink (scr, ink);
+	scr_paper (scr, paper);
+    } else {
+	bit_ink (canvas, ink);
+	bit_paper (canvas, paper);
+    }
+}
+
+static void font (Font *font)
+{
+    if (scr)
+	scr_font (scr, font);
+    else
+	bit_font (canvas, font);
+}
+
+static void clip (int x, int y, int w, int h)
+{
+    if (scr)
+	scr_clip (scr, x, y, w, h);
+    else
+	bit_clip (canvas, x, y, w, h);
+}
+
+static void region (ClipRegion *region)
+{
+    if (scr)
+	scr_region (scr, region);
+    else
+	bit_region (canvas, region);
+}
+
+/* Modules that draw only on screens are checked on the canvas target
+   by borrowing the CGA screen, and copying it to the canvas after */
+
+static void borrow (void)
+{
+    if (! scr) {
+	scr = screens[0];
+	borrowed = 1;
+	clip (0, 0, 320, 200);
+	colours (0, 0);
+	box (0, 0, 320, 200);
+	colours (3, 0);
+    }
+}
+
+static void give_back (void)
+{
+    if (borrowed) {
+	scr_get (scr, canvas, 0, 0);
+	scr = NULL;
+	borrowed = 0;
+    }
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Routines.
+ */
+
+/**
+ * Draw the demonstration program's playfield, with a repeatable map.
+ */
+static void draw_playfield (void)
+{
+    /* local variables */
+    int x; /* x coordinate counter */
+    int y; /* y coordinate counter */
+    int walls[8] = {8, 8, 8, 8, 8, 8, 14, 15}; /* random wall pieces */
+    int piece; /* map piece: 0 floor, 1 player, 3 droid */
+
+    /* the walls around the edge */
+    seed = 1;
+    put (bit[7], 0, 0, DRAW_PSET);
+    put (bit[9], 304, 0, DRAW_PSET);
+    put (bit[12], 0, 176, DRAW_PSET);
+    put (bit[13], 304, 176, DRAW_PSET);
+    for (x = 1; x < 19; ++x) {
+	put (bit[walls[random_number (8)]], 16 * x, 0, DRAW_PSET);
+	put (bit[walls[random_number (8)]], 16 * x, 176, DRAW_PSET);
+    }
+    for (y = 1; y < 11; ++y) {
+	put (bit[10], 0, 16 * y, DRAW_PSET);
+	put (bit[11], 304, 16 * y, DRAW_PSET);
+    }
+
+    /* the floor, with the player and droids masked onto it */
+    for (x = 0; x < 18; ++x)
+	for (y = 0; y < 10; ++y) {
+	    put (bit[0], 16 + 16 * x, 16 + 16 * y, DRAW_PSET);
+	    piece = random_number (8);
+	    if (piece == 1 || piece == 3) {
+		put (bit[piece + 1], 16 + 16 * x, 16 + 16 * y, DRAW_AND);
+		put (bit[piece], 16 + 16 * x, 16 + 16 * y, DRAW_OR);
+	    }
+	}
+
+    /* the score line */
+    font (fonts[2]);
+    colours (3, 0);
+    print (300, 192, "01234");
+}
+
+/**
+ * Print a font's characters in every ink and paper combination.
+ * @param f is the font to use.
+ */
+static void draw_font (Font *f)
+{
+    /* local variables */
+    char message[81]; /* the characters to print */
+    int c; /* character counter */
+    int ink; /* ink colour counter */
+    int paper; /* paper colour counter */
+
+    /* fill the message with as many of the characters as will fit */
+    for (c = 0; c < 80 && f->first + c <= f->last; ++c)
+	message[c] = f->first + c;
+    message[c] = '\0';
+
+    /* print a line for each combination, on a coloured background */
+    colours (1, 0);
+    box (0, 0, 320, 200);
+    font (f);
+    for (ink = 0; ink < 4; ++ink)
+	for (paper = 0; paper < 4; ++paper) {
+	    colours (ink, paper);
+	    print (0, 4 + 12 * (4 * ink + paper), message);
+	}
+}
+
+/**
+ * Draw the first font's characters.
+ */
+static void draw_font1 (void)
+{
+    draw_font (fonts[0]);
+}
+
+/**
+ * Draw the second font's characters.
+ */
+static void draw_font2 (void)
+{
+    draw_font (fonts[1]);
+}
+
+/**
+ * Draw the third font's characters.
+ */
+static void draw_font3 (void)
+{
+    draw_font (fonts[2]);
+}
+
+/**
+ * Put a sprite in every draw mode at every alignment, over stripes.
+ */
+static void draw_modes (void)
+{
+    /* local variables */
+    int c; /* colour counter */
+    int m; /* draw mode counter */
+    int a; /* alignment counter */
+
+    /* stripes of each colour across the screen */
+    for (c = 0; c < 4; ++c) {
+	colours (c, 0);
+	box (0, 50 * c, 320, 50);
+	box (80 * c, 0, 8, 200);
+    }
+
+    /* the sprite and half of it in each mode, on and off alignment */
+    for (m = 0; m < 5; ++m)
+	for (a = 0; a < 4; ++a) {
+	    put (sprite, 4 + 64 * m + a, 4 + 48 * a, m);
+	    putpart (sprite, 36 + 64 * m, 4 + 48 * a + a, 4 * a, a,
+		     16, 16, m);
+	}
+}
+
+/**
+ * Draw across the edges of a clipping rectangle and a clip region.
+ */
+static void draw_clipping (void)
+{
+    /* local variables */
+    ClipRegion *r; /* a clip region with a hole in it */
+    Bitmap *got; /* a bitmap taken from the target */
+    int c; /* counter */
+
+    /* sprites and boxes across the edges of the screen */
+    colours (2, 0);
+    box (0, 0, 320, 200);
+    put (sprite, -16, -16, DRAW_PSET);
+    put (sprite, 304, 184, DRAW_XOR);
+    putpart (sprite, 300, -8, 8, 8, 32, 32, DRAW_PSET);
+
+    /* sprites, boxes and text across a clipping rectangle */
+    clip (40, 20, 120, 80);
+    colours (1, 3);
+    box (20, 10, 80, 40);
+    put (sprite, 140, 84, DRAW_OR);
+    put (sprite, 28, 90, DRAW_PSET);
+    font (fonts[1]);
+    print (100, 96, "Clipped text");
+    clip (0, 0, 320, 200);
+
+    /* the same, through a clip region with a hole in it */
+    if (! (r = rgn_create (320, 200))
+	|| ! rgn_union (r, 160, 100, 160, 100)
+	|| ! rgn_subtract (r, 200, 130, 40, 40))
+	error_handler (1, "Out of memory creating clip region");
+    region (r);
+    colours (3, 1);
+    box (150, 90, 120, 60);
+    for (c = 0; c < 6; ++c)
+	put (sprite, 176 + 16 * c, 120 + 4 * c, c % 5);
+    print (180, 150, "Region text");
+    region (NULL);
+    rgn_destroy (r);
+
+    /* scroll an area in each direction, and copy part of the result */
+    scroll (0, 100, 160, 100, 8, 4, 1);
+    scroll (0, 100, 160, 100, -4, -2, -1);
+    if (! (got = bit_create (64, 32)))
+	error_handler (1, "Out of memory creating bitmap");
+    get (got, 152, 96);
+    put (got, 8, 160, DRAW_XOR);
+    bit_destroy (got);
+}
+
+/**
+ * Put compiled sprites masked from the demonstration bitmaps.
+ */
+static void draw_compiled (void)
+{
+    /* local variables */
+    Compiled *player; /* the player compiled with its mask */
+    Compiled *droid; /* a droid compiled with its mask */
+    int c; /* counter */
+
+    /* compile the sprites */
+    if (! (player = cpl_create (bit[1], bit[2]))
+	|| ! (droid = cpl_create (bit[3], bit[4])))
+	error_handler (1, "Out of memory compiling sprites");
+
+    /* put them over a floor */
+    for (c = 0; c < 240; ++c)
+	put (bit[0], (c % 20) * 16, (c / 20) * 16, DRAW_PSET);
+    colours (2, 0);
+    box (0, 192, 320, 8);
+    for (c = 0; c < 20; ++c) {
+	putcompiled (player, 16 * c, 8 * (c % 12) + 4);
+	putcompiled (droid, 288 - 12 * c, 8 + 8 * c);
+    }
+
+    /* and across the edges of a clipping rectangle */
+    clip (96, 160, 128, 32);
+    for (c = 0; c < 5; ++c)
+	putcompiled (droid, 88 + 32 * c, 152 + 16 * (c % 3));
+    clip (0, 0, 320, 200);
+
+    /* clean up */
+    cpl_destroy (droid);
+    cpl_destroy (player);
+}
+
+/**
+ * Move sprites in a sprite layer so that they overlap, restack them,
+ * hide and destroy some, and draw on the background beneath them.
+ */
+static void draw_sprites (void)
+{
+    /* local variables */
+    SpriteLayer *layer; /* the layer of sprites */
+    Sprite *sprites[6]; /* two players, three droids and a pattern */
+    Bitmap *kept; /* the finished picture */
+    int c; /* counter */
+    int f; /* frame counter */
+
+    /* a floor for the sprites to move over */
+    borrow ();
+    for (c = 0; c < 240; ++c)
+	put (bit[0], (c % 20) * 16, (c / 20) * 16, DRAW_PSET);
+    if (! (layer = spr_createlayer (scr)))
+	error_handler (1, "Out of memory creating sprite layer");
+    for (c = 0; c < 6; ++c)
+	if (! (sprites[c] = (c < 2)
+	       ? spr_create (layer, bit[1], bit[2], 1)
+	       : (c < 5)
+	       ? spr_create (layer, bit[3], bit[4], 0)
+	       : spr_create (layer, sprite, NULL, 2)))
+	    error_handler (1, "Out of memory creating sprites");
+
+    /* the players cross the droids' paths, and the pre-shifted pattern
+       moves a pixel at a time across them all */
+    for (f = 0; f < 12; ++f) {
+	for (c = 0; c < 2; ++c)
+	    spr_move (sprites[c], 40 + 16 * f, 60 + 40 * c + 2 * f);
+	for (c = 2; c < 5; ++c)
+	    if (sprites[c])
+		spr_move (sprites[c], 64 + 48 * (c - 2) + 4 * f, 150 - 9 * f);
+	spr_move (sprites[5], 120 + 3 * f, 70 + f);
+	if (f == 4)
+	    spr_depth (sprites[5], 0);
+	else if (f == 6)
+	    spr_depth (sprites[2], 3);
+	else if (f == 7)
+	    spr_show (sprites[0], 0);
+	else if (f == 9)
+	    spr_show (sprites[0], 1);
+	else if (f == 10) {
+	    spr_destroy (sprites[4]);
+	    sprites[4] = NULL;
+	}
+	if (f == 8) {
+	    spr_erase (layer);
+	    colours (1, 0);
+	    box (96, 88, 96, 24);
+	}
+	if (spr_update (layer) < 0)
+	    error_handler (1, "Out of memory drawing sprites");
+    }
+
+    /* destroying the layer takes the sprites off, so keep the picture */
+    if (! (kept = bit_create (320, 200)))
+	error_handler (1, "Out of memory creating bitmap");
+    get (kept, 0, 0);
+    spr_destroylayer (layer);
+    put (kept, 0, 0, DRAW_PSET);
+    bit_destroy (kept);
+    give_back ();
+}
+
+/**
+ * Compose an opaque floor, keyed droids, masked players and a hidden
+ * panel in an area of the screen, changing each in turn.
+ */
+static void draw_layers (void)
+{
+    /* local variables */
+    Compositor *compositor; /* the compositor */
+    Bitmap *layers[4]; /* floor, droids, players and panel */
+    Bitmap *mask; /* the mask of the players' layer */
+    int c; /* counter */
+
+    /* a floor around the area, which is at (48,40) and 224x120 */
+    borrow ();
+    for (c = 0; c < 240; ++c)
+	put (bit[0], (c % 20) * 16, (c / 20) * 16, DRAW_PSET);
+    for (c = 0; c < 4; ++c) {
+	if (! (layers[c] = bit_create (224, 120)))
+	    error_handler (1, "Out of memory creating layers");
+	bit_ink (layers[c], 0);
+	bit_box (layers[c], 0, 0, 224, 120);
+    }
+    if (! (mask = bit_create (224, 120))
+	|| ! (compositor = cmp_create (scr, 48, 40, 224, 120)))
+	error_handler (1, "Out of memory creating compositor");
+
+    /* the layers: the floor, droids keyed on colour 0, the players
+       with a mask, and a panel that starts hidden */
+    bit_ink (layers[0], 1);
+    bit_box (layers[0], 0, 0, 224, 120);
+    for (c = 0; c < 21; ++c)
+	bit_put (layers[0], bit[8 + c % 3], 16 * (c % 7) + 56,
+		 16 * (c / 7) + 40, DRAW_PSET);
+    for (c = 0; c < 5; ++c)
+	bit_put (layers[1], bit[3], 8 + 44 * c, 12 + 20 * c, DRAW_PSET);
+    bit_ink (mask, 3);
+    bit_box (mask, 0, 0, 224, 120);
+    for (c = 0; c < 3; ++c) {
+	bit_put (layers[2], bit[1], 24 + 64 * c, 48 + 4 * c, DRAW_PSET);
+	bit_put (mask, bit[2], 24 + 64 * c, 48 + 4 * c, DRAW_PSET);
+    }
+    bit_ink (layers[3], 2);
+    bit_box (layers[3], 0, 104, 224, 16);
+    if (cmp_addlayer (compositor, layers[0], NULL, CMP_OPAQUE) < 0
+	|| cmp_addlayer (compositor, layers[1], NULL, CMP_KEYED) < 0
+	|| cmp_addlayer (compositor, layers[2], mask, CMP_MASKED) < 0
+	|| cmp_addlayer (compositor, layers[3], NULL, CMP_KEYED) < 0)
+	error_handler (1, "Out of memory adding layers");
+    cmp_show (compositor, 3, 0);
+    cmp_update (compositor);
+
+    /* move a droid, hide the players, then show the panel */
+    bit_box (layers[1], 96, 52, 16, 16);
+    bit_put (layers[1], bit[3], 104, 60, DRAW_PSET);
+    cmp_dirty (compositor, 1, 96, 52, 24, 24);
+    cmp_update (compositor);
+    cmp_show (compositor, 2, 0);
+    cmp_update (compositor);
+    bit_put (layers[3], bit[3], 104, 104, DRAW_PSET);
+    cmp_dirty (compositor, 3, 104, 104, 16, 16);
+    cmp_show (compositor, 3, 1);
+    cmp_update (compositor);
+
+    /* show the players again, one of them moved under the panel */
+    bit_box (layers[2], 24, 48, 16, 16);
+    bit_box (mask, 24, 48, 16, 16);
+    bit_put (layers[2], bit[1], 32, 96, DRAW_PSET);
+    bit_put (mask, bit[2], 32, 96, DRAW_AND);
+    cmp_dirty (compositor, 2, 24, 48, 24, 64);
+    cmp_show (compositor, 2, 1);
+    cmp_update (compositor);
+
+    /* clean up */
+    cmp_destroy (compositor);
+    bit_destroy (mask);
+    for (c = 0; c < 4; ++c)
+	bit_destroy (layers[c]);
+    give_back ();
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/** @struct scene is a scene to draw, and its correct hash. */
+static struct scene {
+    char *name; /* the name, used for any PPM file written */
+    void (*draw) (void); /* the routine that draws it */
+    unsigned long hash; /* the hash of a correct drawing */
+} scenes[SCENES] = {
+    {"field", draw_playfield, 0x7d3435efUL},
+    {"font1", draw_font1, 0x9d1a2682UL},
+    {"font2", draw_font2, 0xb122ba42UL},
+    {"font3", draw_font3, 0x08ba0c62UL},
+    {"modes", draw_modes, 0x8c962938UL},
+    {"clip", draw_clipping, 0xdd668989UL},
+    {"cpl", draw_compiled, 0x488e1429UL},
+    {"sprite", draw_sprites, 0xfba4e4feUL},
+    {"layers", draw_layers, 0xbd1e86b9UL}
+};
+
+/**
+ * Load and validate a font.
+ * @param filename is the name of the font file.
+ * @returns the loaded font.
+ */
+static Font *load_font (char *filename)
+{
+    /* local variables */
+    Font *font; /* the font read */
+    FILE *fp; /* the font file */
+    char header[8]; /* the header read from the file */
+
+    /* open the file, check its header and read the font */
+    if (! (fp = fopen (filename, "rb")))
+	return NULL;
+    font = NULL;
+    if (fread (header, 8, 1, fp) && ! strcmp (header, "CGA100F"))
+	font = fnt_read (fp);
+    fclose (fp);
+    return font;
+}
+
+/**
+ * Load the demonstration bitmaps, and make the patterned sprite.
+ * @param filename is the bitmap file.
+ * @returns 1 on success, 0 on failure.
+ */
+static int load_bitmaps (char *filename)
+{
+    /* local variables */
+    FILE *fp; /* the bitmap file */
+    char header[8]; /* the header read from the file */
+    int c; /* bitmap counter */
+
+    /* open the file, check its header and read the bitmaps */
+    if (! (fp = fopen (filename, "rb")))
+	return 0;
+    if (! fread (header, 8, 1, fp) || strcmp (header, "CGA100B")) {
+	fclose (fp);
+	return 0;
+    }
+    for (c = 0; c < 16; ++c)
+	if (! (bit[c] = bit_read (fp))) {
+	    fclose (fp);
+	    return 0;
+	}
+    fclose (fp);
+
+    /* make a sprite with every colour in it, and pre-shift it */
+    if (! (sprite = bit_create (32, 32)))
+	return 0;
+    for (c = 0; c < 4; ++c) {
+	bit_ink (sprite, c);
+	bit_box (sprite, 4 * c, 4 * c, 32 - 8 * c, 32 - 8 * c);
+    }
+    bit_put (sprite, bit[3], 8, 8, DRAW_XOR);
+    return bit_preshift (sprite);
+}
+
+#ifdef CGALIB_RECORD
+/**
+ * Play back the log of a scene on a new screen, and compare hashes.
+ * @param log is the log, which is closed.
+ * @param hash is the hash of the scene as drawn.
+ * @returns 1 if the hashes match, 0 if not.
+ */
+static int replayed (FILE *log, unsigned long hash)
+{
+    /* local variables */
+    Screen *copy; /* the screen played back on */
+    int same; /* 1 if the hashes match */
+
+    /* stop recording before the new screen is created */
+    rec_stop ();
+    rewind (log);
+    if (! (copy = scr_createmem (scr->mode)))
+	error_handler (1, "Out of memory");
+    same = rec_replay (log, copy) >= 0 && scr_hash (copy) == hash;
+    scr_destroy (copy);
+    fclose (log);
+    return same;
+}
+#endif
+
+/**
+ * Draw a scene on a target, and compare its hash.
+ * @param s is the scene number.
+ * @param t is the target number.
+ * @param list is 1 to list the hash rather than compare it.
+ * @returns 1 if the hash is correct, 0 if not.
+ */
+static int check (int s, int t, int list)
+{
+    /* local variables */
+    unsigned long hash; /* the hash of the scene drawn */
+    char filename[13]; /* name of the PPM file to write */
+    FILE *output; /* the PPM file */
+    int played; /* 1 if the scene plays back the same from its log */
+#ifdef CGALIB_RECORD
+    FILE *log; /* the log of the scene, or NULL */
+#endif
+
+    /* clear the target and draw the scene, recording it on a screen
+       if the library records */
+    scr = t ? screens[t - 1] : NULL;
+#ifdef CGALIB_RECORD
+    if ((log = scr ? tmpfile () : NULL) && ! rec_start (log)) {
+	fclose (log);
+	log = NULL;
+    }
+#endif
+    clip (0, 0, 320, 200);
+    colours (0, 0);
+    box (0, 0, 320, 200);
+    colours (3, 0);
+    scenes[s].draw ();
+    hash = scr ? scr_hash (scr) : bit_hash (canvas);
+    played = 1;
+#ifdef CGALIB_RECORD
+    if (log)
+	played = replayed (log, hash);
+#endif
+
+    /* report the hash, writing a PPM image if it is wrong */
+    printf ("%-7s%-9s%08lx", scenes[s].name, targets[t], hash);
+    if (list) {
+	printf ("\n");
+	return 1;
+    }
+    if (hash == scenes[s].hash && played) {
+	printf (" ok\n");
+	return 1;
+    }
+    if (hash == scenes[s].hash) {
+	printf (" FAILED on replay\n");
+	return 0;
+    }
+    printf (" FAILED, expected %08lx\n", scenes[s].hash);
+    if (scr)
+	scr_get (scr, canvas, 0, 0);
+    sprintf (filename, "%s-%c.ppm", scenes[s].name, targets[t][0]);
+    if ((output = fopen (filename, "wb"))) {
+	if (imp_writeppm (canvas, output, 4, 0))
+	    printf ("%s written\n", filename);
+	fclose (output);
+    }
+    return 0;
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main program.
+ * @param argc is the number of command line arguments.
+ * @param argv is the command line arguments.
+ * No return value as exit () is used to terminate.
+ */
+void main (int argc, char **argv)
+{
+    /* local variables */
+    int list; /* 1 to list the hashes instead of checking them */
+    int failed; /* number of failed checks */
+    int s; /* scene counter */
+    int t; /* target counter */
+    clock_t start; /* clock reading at the start */
+
+    /* read the options */
+    list = 0;
+    if (argc == 2 && ! strcmp (argv[1], "-l"))
+	list = 1;
+    else if (argc != 1)
+	error_handler (1, "Usage: golden [-l]");
+
+    /* load the fonts and bitmaps, and create the targets */
+    if (! (fonts[0] = load_font ("fnt/past.fnt"))
+	|| ! (fonts[1] = load_font ("fnt/present.fnt"))
+	|| ! (fonts[2] = load_font ("fnt/future.fnt")))
+	error_handler (1, "Cannot load fonts");
+    if (! load_bitmaps ("bit/demo.bit"))
+	error_handler (1, "Cannot load bitmaps");
+    if (! (canvas = bit_create (320, 200))
+	|| ! (screens[0] = scr_createmem (4))
+	|| ! (screens[1] = scr_createmem (7)))
+	error_handler (1, "Out of memory");
+
+    /* draw each scene on each target */
+    start = clock ();
+    failed = 0;
+    for (s = 0; s < SCENES; ++s)
+	for (t = 0; t < TARGETS; ++t)
+	    failed += ! check (s, t, list);
+    printf ("%d of %d checks failed in %.1f seconds\n", failed,
+	    SCENES * TARGETS,
+	    (double) (clock () - start) / CLOCKS_PER_SEC);
+
+    /* clean up */
+    scr_destroy (screens[1]);
+    scr_destroy (screens[0]);
+    bit_destroy (canvas);
+    bit_destroy (sprite);
+    for (t = 0; t < 16; ++t)
+	bit_destroy (bit[t]);
+    for (t = 0; t < 3; ++t)
+	fnt_destroy (fonts[t]);
+    exit (failed ? 2 : 0);
+}
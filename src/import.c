@@ -0,0 +1,291 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Import Module.
+ *
+ * Conversion of true colour images into bitmaps, by nearest colour
+ * matching against the CGA palettes with optional ordered dithering,
+ * and of bitmaps back into true colour images.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @var rgbi The red, green and blue levels of the 16 CGA colours. */
+static unsigned char rgbi[16][3] = {
+    {0x00, 0x00, 0x00}, {0x00, 0x00, 0xaa}, /* black, blue */
+    {0x00, 0xaa, 0x00}, {0x00, 0xaa, 0xaa}, /* green, cyan */
+    {0xaa, 0x00, 0x00}, {0xaa, 0x00, 0xaa}, /* red, magenta */
+    {0xaa, 0x55, 0x00}, {0xaa, 0xaa, 0xaa}, /* brown, light grey */
+    {0x55, 0x55, 0x55}, {0x55, 0x55, 0xff}, /* dark grey, light blue */
+    {0x55, 0xff, 0x55}, {0x55, 0xff, 0xff}, /* light green, light cyan */
+    {0xff, 0x55, 0x55}, {0xff, 0x55, 0xff}, /* light red, light magenta */
+    {0xff, 0xff, 0x55}, {0xff, 0xff, 0xff}  /* yellow, white */
+};
+
+/** @var foreground The colours 1..3 of each palette, as scr_palette. */
+static int foreground[7][3] = {
+    {2, 4, 6}, /* palette 0 */
+    {3, 5, 7}, /* palette 1 */
+    {3, 4, 7}, /* palette 2 */
+    {10, 12, 14}, /* palette 3 */
+    {11, 13, 15}, /* palette 4 */
+    {11, 12, 15}, /* palette 5 */
+    {7, 7, 15} /* mode 6: colours 1 and 2 are a 50% dither */
+};
+
+/** @var bayer The 4x4 ordered dither threshold matrix. */
+static int bayer[4][4] = {
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5}
+};
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Build the table of colours in a palette.
+ * @param table is the table to fill with the four palette colours.
+ * @param palette is the palette number 0..5, or 6 for mode 6.
+ * @param colour is the background colour, 0..15.
+ */
+static void build_table (int table[4][3], int palette, int colour)
+{
+    int c; /* colour counter */
+
+    /* background colour first, then the three foreground colours */
+    for (c = 0; c < 3; ++c)
+	table[0][c] = (palette == 6) ? 0 : rgbi[colour][c];
+    for (c = 1; c < 4; ++c) {
+	table[c][0] = rgbi[foreground[palette][c - 1]][0];
+	table[c][1] = rgbi[foreground[palette][c - 1]][1];
+	table[c][2] = rgbi[foreground[palette][c - 1]][2];
+    }
+}
+
+/**
+ * Find the nearest palette entry to a colour.
+ * @param table is the four palette colours.
+ * @param r is the red level.
+ * @param g is the green level.
+ * @param b is the blue level.
+ * @returns the pixel value 0..3.
+ */
+static int nearest (int table[4][3], int r, int g, int b)
+{
+    int c; /* colour counter */
+    int best; /* best colour so far */
+    long dist; /* distance of current colour */
+    long bestdist; /* distance of best colour so far */
+
+    best = 0;
+    bestdist = 0x7fffffffL;
+    for (c = 0; c < 4; ++c) {
+	dist = (long) (r - table[c][0]) * (r - table[c][0])
+	    + (long) (g - table[c][1]) * (g - table[c][1])
+	    + (long) (b - table[c][2]) * (b - table[c][2]);
+	if (dist < bestdist) {
+	    best = c;
+	    bestdist = dist;
+	}
+    }
+    return best;
+}
+
+/**
+ * Skip white space and comments in a PPM header.
+ * @param input is the input file handle.
+ * @returns the next non-blank character.
+ */
+static int ppm_skip (FILE *input)
+{
+    int ch; /* character read */
+
+    do {
+	ch = fgetc (input);
+	if (ch == '#')
+	    while (ch != '\n' && ch != EOF)
+		ch = fgetc (input);
+    } while (ch != EOF && isspace (ch));
+    return ch;
+}
+
+/**
+ * Read an unsigned number from a PPM header.
+ * @param input is the input file handle.
+ * @returns the number, or -1 if there is none.
+ */
+static int ppm_number (FILE *input)
+{
+    int ch; /* character read */
+    int n; /* number read */
+
+    if (! isdigit (ch = ppm_skip (input)))
+	return -1;
+    for (n = 0; isdigit (ch); ch = fgetc (input))
+	n = 10 * n + ch - '0';
+    return n;
+}
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Convert rows of true colour pixels into a bitmap.
+ * @param dst is the destination bitmap, whose size is already set.
+ * @param rgb is the row data, 3 bytes per pixel, dst->width wide.
+ * @param y is the first bitmap row to convert.
+ * @param h is the number of rows to convert.
+ * @param palette is the palette number 0..5, or 6 for mode 6.
+ * @param colour is the background colour, 0..15.
+ * @param dither is 1 for ordered dithering, 0 for none.
+ * The rows are independent of each other, so a large image can be
+ * converted a band at a time.
+ */
+void imp_rows (Bitmap *dst, unsigned char *rgb, int y, int h,
+	       int palette, int colour, int dither)
+{
+    /* local variables */
+    int table[4][3]; /* the four colours of the palette */
+    int r; /* row counter */
+    int x; /* pixel counter */
+    int t; /* dither threshold */
+    char *d; /* address to convert data to */
+    char v; /* byte being built */
+
+    /* build the palette */
+    build_table (table, palette, colour);
+
+    /* convert each row */
+    if (! bit_own (dst))
+	return;
+    for (r = y; r < y + h; ++r) {
+	d = dst->pixels + dst->stride * r;
+	v = 0;
+	for (x = 0; x < dst->width; ++x) {
+	    t = dither ? 4 * bayer[r & 3][x & 3] - 30 : 0;
+	    v = (v << 2) | nearest (table, rgb[0] + t, rgb[1] + t,
+				    rgb[2] + t);
+	    if ((x & 3) == 3)
+		*d++ = v;
+	    rgb += 3;
+	}
+    }
+    REC_LOAD (dst);
+}
+
+/**
+ * Read a binary PPM image from an already-open file.
+ * @param input is the input file handle.
+ * @param palette is the palette number 0..5, or 6 for mode 6.
+ * @param colour is the background colour, 0..15.
+ * @param dither is 1 for ordered dithering, 0 for none.
+ * @returns a new Bitmap.
+ */
+Bitmap *imp_ppm (FILE *input, int palette, int colour, int dither)
+{
+    /* local variables */
+    Bitmap *bitmap; /* the bitmap to return */
+    unsigned char *rgb; /* buffer for one row of the image */
+    int w; /* image width */
+    int h; /* image height */
+    int max; /* maximum colour level */
+    int r; /* row counter */
+    int p; /* pixel level counter */
+
+    /* read and check the header */
+    if (ppm_skip (input) != 'P' || fgetc (input) != '6')
+	return NULL;
+    w = ppm_number (input);
+    h = ppm_number (input);
+    max = ppm_number (input);
+    if (w <= 0 || h <= 0 || max <= 0 || max > 255)
+	return NULL;
+
+    /* reserve memory; the bitmap is widened to a whole byte */
+    if (! (bitmap = bit_create ((w + 3) & ~3, h)))
+	return NULL;
+    if (! (rgb = calloc (bitmap->width, 3))) {
+	bit_destroy (bitmap);
+	return NULL;
+    }
+
+    /* convert the image a row at a time */
+    for (r = 0; r < h; ++r) {
+	if (! fread (rgb, 3 * w, 1, input)) {
+	    free (rgb);
+	    bit_destroy (bitmap);
+	    return NULL;
+	}
+	if (max != 255)
+	    for (p = 0; p < 3 * w; ++p)
+		rgb[p] = (unsigned) rgb[p] * 255 / max;
+	imp_rows (bitmap, rgb, r, 1, palette, colour, dither);
+    }
+
+    /* clean up and return the bitmap */
+    free (rgb);
+    return bitmap;
+}
+
+/**
+ * Write a bitmap to an already-open file as a binary PPM image.
+ * @param src is the bitmap to write.
+ * @param output is the output file handle.
+ * @param palette is the palette number 0..5, or 6 for mode 6.
+ * @param colour is the background colour, 0..15.
+ * @returns 1 on success, 0 on failure.
+ */
+int imp_writeppm (Bitmap *src, FILE *output, int palette, int colour)
+{
+    /* local variables */
+    int table[4][3]; /* the four colours of the palette */
+    unsigned char *rgb; /* buffer for one row of the image */
+    unsigned char *d; /* address to convert data to */
+    char *s; /* address of the byte being converted */
+    int r; /* row counter */
+    int x; /* pixel counter */
+    int p; /* pixel value */
+    int ok; /* 1 if all the rows were written */
+
+    /* build the palette and reserve memory */
+    build_table (table, palette, colour);
+    if (! (rgb = malloc (3 * src->width)))
+	return 0;
+
+    /* write the header, then convert and write each row */
+    ok = fprintf (output, "P6\n%d %d\n255\n", src->width, src->height)
+	> 0;
+    for (r = 0; ok && r < src->height; ++r) {
+	s = bit_row (src, r);
+	d = rgb;
+	for (x = 0; x < src->width; ++x) {
+	    p = (s[x / 4] >> (6 - 2 * (x & 3))) & 3;
+	    *d++ = table[p][0];
+	    *d++ = table[p][1];
+	    *d++ = table[p][2];
+	}
+	ok = fwrite (rgb, 3 * src->width, 1, output);
+    }
+
+    /* clean up and return */
+    free (rgb);
+    return ok;
+}
@@ -0,0 +1,454 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Loader Module.
+ *
+ * Queues bitmap and font files for loading. Where the library is built
+ * with CGALIB_THREADS, a worker thread loads them in the background;
+ * otherwise, or if asked, each is loaded in turn when the program
+ * polls for it.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Read the bitmaps in an open bitmap file.
+ * @param job is the job to store the bitmaps in.
+ * @param input is the file, positioned after its header.
+ * @returns 1 on success, 0 on failure.
+ */
+static int read_bitmaps (LoadJob *job, FILE *input)
+{
+    /* local variables */
+    Bitmap **bitmaps; /* enlarged list of bitmaps */
+    Bitmap *bitmap; /* the bitmap being read */
+    int size; /* room in the list of bitmaps */
+    int w; /* the width read from the file */
+    int h; /* the height read from the file */
+
+    /* read each bitmap, making more room in the list as needed */
+    size = 0;
+    w = h = 0;
+    while (fread (&w, 2, 1, input) && fread (&h, 2, 1, input)) {
+	if (job->count == size) {
+	    size = size ? 2 * size : 16;
+	    if (! (bitmaps = realloc (job->bitmaps,
+				      size * sizeof (Bitmap *))))
+		return 0;
+	    job->bitmaps = bitmaps;
+	}
+	if (! (bitmap = bit_createin (job->allocator, w, h)))
+	    return 0;
+	if (! fread (bitmap->pixels, (size_t) (w / 4) * h, 1, input)) {
+	    bit_destroy (bitmap);
+	    return 0;
+	}
+	job->bitmaps[job->count++] = bitmap;
+    }
+    return 1;
+}
+
+/**
+ * Read the font in an open font file.
+ * @param job is the job to store the font in.
+ * @param input is the file, positioned after its header.
+ * @returns 1 on success, 0 on failure.
+ */
+static int read_font (LoadJob *job, FILE *input)
+{
+    /* local variables */
+    char f; /* first character code read from file */
+    char l; /* last character code read from file */
+
+    /* read the character range and the pixel data */
+    if (! fread (&f, 1, 1, input) || ! fread (&l, 1, 1, input)
+	|| ! (job->font = fnt_createin (job->allocator, f, l)))
+	return 0;
+    if (! fread (job->font->pixels, 8 * (l - f + 1), 1, input)) {
+	fnt_destroy (job->font);
+	job->font = NULL;
+	return 0;
+    }
+    return 1;
+}
+
+/**
+ * Destroy everything a job has loaded.
+ * @param job is the job.
+ */
+static void unload (LoadJob *job)
+{
+    while (job->count)
+	bit_destroy (job->bitmaps[--job->count]);
+    fnt_destroy (job->font);
+    job->font = NULL;
+}
+
+/**
+ * Load the file for a job.
+ * @param job is the job.
+ * @returns the job's new status.
+ */
+static LoadStatus load (LoadJob *job)
+{
+    /* local variables */
+    FILE *input; /* the file to load */
+    char header[8]; /* the header read from the file */
+    int ok; /* 1 if the file was read successfully */
+
+    /* open the file, and read its contents according to its header */
+    ok = 0;
+    if ((input = fopen (job->filename, "rb"))) {
+	if (! fread (header, 8, 1, input))
+	    ok = 0;
+	else if (! strcmp (header, "CGA100B"))
+	    ok = read_bitmaps (job, input);
+	else if (! strcmp (header, "CGA100F"))
+	    ok = read_font (job, input);
+	fclose (input);
+    }
+
+    /* a file that cannot be read in full yields nothing */
+    if (! ok)
+	unload (job);
+    return ok ? LDR_DONE : LDR_FAILED;
+}
+
+/**
+ * Add a job to the end of a queue.
+ * @param queue is the address of the first job in the queue.
+ * @param job is the job to add.
+ */
+static void append (LoadJob **queue, LoadJob *job)
+{
+    job->next = NULL;
+    while (*queue)
+	queue = &(*queue)->next;
+    *queue = job;
+}
+
+/**
+ * Take the first job from a queue.
+ * @param queue is the address of the first job in the queue.
+ * @returns the job, or NULL if the queue is empty.
+ */
+static LoadJob *take (LoadJob **queue)
+{
+    /* local variables */
+    LoadJob *job; /* the job to return */
+
+    if ((job = *queue))
+	*queue = job->next;
+    return job;
+}
+
+#ifdef CGALIB_THREADS
+
+/**
+ * Load queued files until the loader is destroyed.
+ * @param arg is the loader.
+ * @returns NULL.
+ */
+static void *work (void *arg)
+{
+    /* local variables */
+    Loader *loader; /* the loader */
+    LoadJob *job; /* the job being loaded */
+    LoadStatus status; /* the status of the job once loaded */
+
+    /* wait for each job, load it outside the lock, and hand it back */
+    loader = arg;
+    pthread_mutex_lock (&loader->lock);
+    while (! loader->quit) {
+	if (! (job = take (&loader->pending))) {
+	    pthread_cond_wait (&loader->wake, &loader->lock);
+	    continue;
+	}
+	++loader->busy;
+	pthread_mutex_unlock (&loader->lock);
+	status = load (job);
+	pthread_mutex_lock (&loader->lock);
+	job->status = status;
+	--loader->busy;
+	append (&loader->done, job);
+	pthread_cond_signal (&loader->finished);
+    }
+    pthread_mutex_unlock (&loader->lock);
+    return NULL;
+}
+
+#endif
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Create a loader.
+ * @param threaded is 1 to load in a worker thread if possible.
+ * @returns the new loader.
+ */
+Loader *ldr_create (int threaded)
+{
+    /* local variables */
+    Loader *loader; /* the loader to return */
+
+    /* reserve memory and initialise the queues */
+    threaded = threaded;
+    if (! (loader = malloc (sizeof (Loader))))
+	return NULL;
+    loader->pending = NULL;
+    loader->done = NULL;
+    loader->busy = 0;
+    loader->threaded = 0;
+
+    /* start the worker thread if asked, and if possible */
+#ifdef CGALIB_THREADS
+    loader->quit = 0;
+    pthread_mutex_init (&loader->lock, NULL);
+    pthread_cond_init (&loader->wake, NULL);
+    pthread_cond_init (&loader->finished, NULL);
+    if (threaded && ! pthread_create (&loader->worker, NULL, work, loader))
+	loader->threaded = 1;
+#endif
+    mem_account (MEM_OTHER, sizeof (Loader), 1);
+
+    /* return the loader */
+    return loader;
+}
+
+/**
+ * Queue a bitmap or font file for loading.
+ * @param loader is the loader.
+ * @param filename is the name of the file.
+ * @returns the job for the file, or NULL if there was no memory.
+ */
+LoadJob *ldr_queue (Loader *loader, char *filename)
+{
+    /* local variables */
+    LoadJob *job; /* the job to return */
+
+    /* create the job */
+    if (! (job = malloc (sizeof (LoadJob))))
+	return NULL;
+    if (! (job->filename = malloc (strlen (filename) + 1))) {
+	free (job);
+	return NULL;
+    }
+    strcpy (job->filename, filename);
+    job->allocator = mem_installed ();
+    job->loader = loader;
+    job->status = LDR_PENDING;
+    job->count = 0;
+    job->bitmaps = NULL;
+    job->font = NULL;
+
+    /* add it to the queue, waking the worker thread if there is one */
+#ifdef CGALIB_THREADS
+    pthread_mutex_lock (&loader->lock);
+    append (&loader->pending, job);
+    pthread_cond_signal (&loader->wake);
+    pthread_mutex_unlock (&loader->lock);
+#else
+    append (&loader->pending, job);
+#endif
+
+    /* return the job */
+    return job;
+}
+
+/**
+ * Return the next job that has finished loading, without waiting.
+ * @param loader is the loader.
+ * @returns the job, or NULL if none has finished.
+ */
+LoadJob *ldr_poll (Loader *loader)
+{
+    /* local variables */
+    LoadJob *job; /* the job to return */
+
+    /* without a worker thread, load one file now */
+    if (! loader->threaded) {
+	if (! loader->done && (job = take (&loader->pending))) {
+	    job->status = load (job);
+	    append (&loader->done, job);
+	}
+	job = take (&loader->done);
+    }
+
+    /* otherwise take any job the worker thread has finished */
+#ifdef CGALIB_THREADS
+    else {
+	pthread_mutex_lock (&loader->lock);
+	job = take (&loader->done);
+	pthread_mutex_unlock (&loader->lock);
+    }
+#else
+    else
+	job = NULL;
+#endif
+
+    /* a job that has been returned is no longer the loader's */
+    if (job)
+	job->loader = NULL;
+    return job;
+}
+
+/**
+ * Return the next job that has finished loading, waiting if need be.
+ * @param loader is the loader.
+ * @returns the job, or NULL if no jobs are left.
+ */
+LoadJob *ldr_wait (Loader *loader)
+{
+    /* local variables */
+    LoadJob *job; /* the job to return */
+
+    /* without a worker thread, polling loads the next file */
+    if (! loader->threaded)
+	return ldr_poll (loader);
+
+    /* otherwise wait while the worker thread has jobs in hand */
+#ifdef CGALIB_THREADS
+    pthread_mutex_lock (&loader->lock);
+    while (! loader->done && (loader->pending || loader->busy))
+	pthread_cond_wait (&loader->finished, &loader->lock);
+    if ((job = take (&loader->done)))
+	job->loader = NULL;
+    pthread_mutex_unlock (&loader->lock);
+#else
+    job = NULL;
+#endif
+    return job;
+}
+
+/**
+ * Return the status of a job.
+ * @param job is the job.
+ * @returns the status.
+ */
+LoadStatus ldr_status (LoadJob *job)
+{
+    /* local variables */
+    LoadStatus status; /* the status to return */
+
+    /* a job the loader still holds may be being loaded */
+#ifdef CGALIB_THREADS
+    if (job->loader) {
+	pthread_mutex_lock (&job->loader->lock);
+	status = job->status;
+	pthread_mutex_unlock (&job->loader->lock);
+	return status;
+    }
+#endif
+    status = job->status;
+    return status;
+}
+
+/**
+ * Return the number of bitmaps loaded by a job.
+ * @param job is the job.
+ * @returns the number of bitmaps, or 0 if it has not finished.
+ */
+int ldr_count (LoadJob *job)
+{
+    /* local variables */
+    int count; /* the count to return */
+
+    /* the count is only complete once the job has finished */
+#ifdef CGALIB_THREADS
+    if (job->loader) {
+	pthread_mutex_lock (&job->loader->lock);
+	count = (job->status == LDR_PENDING) ? 0 : job->count;
+	pthread_mutex_unlock (&job->loader->lock);
+	return count;
+    }
+#endif
+    count = job->count;
+    return count;
+}
+
+/**
+ * Return a bitmap loaded by a job.
+ * @param job is the job.
+ * @param n is the number of the bitmap, counting from 0.
+ * @returns the bitmap, or NULL if n is out of range.
+ */
+Bitmap *ldr_bitmap (LoadJob *job, int n)
+{
+    if (n < 0 || n >= job->count)
+	return NULL;
+    return job->bitmaps[n];
+}
+
+/**
+ * Return the font loaded by a job.
+ * @param job is the job.
+ * @returns the font, or NULL if the file held no font.
+ */
+Font *ldr_font (LoadJob *job)
+{
+    return job->font;
+}
+
+/**
+ * Free a finished job, leaving its bitmaps and font to the program.
+ * @param job is the job.
+ */
+void ldr_release (LoadJob *job)
+{
+    if (job) {
+	if (job->bitmaps)
+	    free (job->bitmaps);
+	free (job->filename);
+	free (job);
+    }
+}
+
+/**
+ * Destroy a loader, and any jobs not yet returned.
+ * @param loader is the loader to destroy.
+ */
+void ldr_destroy (Loader *loader)
+{
+    /* local variables */
+    LoadJob *job; /* job being discarded */
+
+    if (loader) {
+
+	/* stop the worker thread, after the file in hand is loaded */
+#ifdef CGALIB_THREADS
+	if (loader->threaded) {
+	    pthread_mutex_lock (&loader->lock);
+	    loader->quit = 1;
+	    pthread_cond_signal (&loader->wake);
+	    pthread_mutex_unlock (&loader->lock);
+	    pthread_join (loader->worker, NULL);
+	}
+	pthread_cond_destroy (&loader->finished);
+	pthread_cond_destroy (&loader->wake);
+	pthread_mutex_destroy (&loader->lock);
+#endif
+
+	/* discard the jobs left in the queues */
+	while ((job = take (&loader->pending)) || (job = take (&loader->done))) {
+	    unload (job);
+	    ldr_release (job);
+	}
+	mem_account (MEM_OTHER, - (long) sizeof (Loader), -1);
+	free (loader);
+    }
+}
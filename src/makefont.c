@@ -405,6 +405,7 @@ static void paste (void)
     if (bitmaps[bcursor])
 	bit_destroy (bitmaps[bcursor]);
     bitmaps[bcursor] = bit_copy (bitmaps[clipboard]);
+    bit_own (bitmaps[bcursor]);
     showbitmap (bcursor);
     expandbitmap ();
 }
@@ -0,0 +1,137 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Image Import Utility.
+ *
+ * Converts true colour PPM images into a CGA100B bitmap file, and
+ * reports the conversion throughput.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* project headers */
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * File Level Variables.
+ */
+
+/** @var palette The palette to convert to, 0..5, or 6 for mode 6. */
+static int palette = 4;
+
+/** @var background The background colour to convert to. */
+static int background = 0;
+
+/** @var dither 1 to use ordered dithering. */
+static int dither = 1;
+
+/*----------------------------------------------------------------------
+ * Service Routines.
+ */
+
+/**
+ * Error Handler.
+ * @param errorlevel is the error level to return to the OS.
+ * @param message is the message to print.
+ */
+void error_handler (int errorlevel, char *message)
+{
+    puts (message);
+    exit (errorlevel);
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Process the command line options.
+ * @param argc is the number of command line arguments.
+ * @param argv is the command line arguments.
+ * @returns the index of the first filename argument.
+ */
+static int options (int argc, char **argv)
+{
+    int a; /* argument counter */
+
+    for (a = 1; a < argc && argv[a][0] == '-'; ++a)
+	if (! strcmp (argv[a], "-m"))
+	    palette = 6;
+	else if (! strcmp (argv[a], "-n"))
+	    dither = 0;
+	else if (! strcmp (argv[a], "-p") && a + 1 < argc)
+	    palette = atoi (argv[++a]) % 6;
+	else if (! strcmp (argv[a], "-c") && a + 1 < argc)
+	    background = atoi (argv[++a]) & 15;
+	else
+	    error_handler (1, "Unknown option");
+    if (argc - a < 2)
+	error_handler (1, "Usage: ppm2bit [-m] [-n] [-p palette]"
+		       " [-c colour] output.bit input.ppm ...");
+    return a;
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main program.
+ * @param argc is the number of command line argumets.
+ * @param argv is the command line arguments.
+ * No return value as exit () is used to terminate abnormally.
+ */
+void main (int argc, char **argv)
+{
+    /* local variables */
+    FILE *output; /* the bitmap file */
+    FILE *input; /* the current image file */
+    Bitmap *bitmap; /* the current converted image */
+    int a; /* argument counter */
+    long pixels; /* total pixels converted */
+    clock_t start; /* clock at start of conversion */
+    clock_t ticks; /* clock ticks taken by conversion */
+
+    /* open the output file and write its header */
+    a = options (argc, argv);
+    if (! (output = fopen (argv[a], "wb")))
+	error_handler (1, "Cannot create output file");
+    if (! fwrite ("CGA100B", 8, 1, output))
+	error_handler (1, "Cannot write output file");
+
+    /* convert each image in turn */
+    pixels = 0;
+    ticks = 0;
+    for (++a; a < argc; ++a) {
+	if (! (input = fopen (argv[a], "rb")))
+	    error_handler (1, "Cannot open input file");
+	start = clock ();
+	bitmap = imp_ppm (input, palette, background, dither);
+	ticks += clock () - start;
+	fclose (input);
+	if (! bitmap)
+	    error_handler (1, "Cannot convert input file");
+	pixels += (long) bitmap->width * bitmap->height;
+	bit_write (bitmap, output);
+	bit_destroy (bitmap);
+    }
+    fclose (output);
+
+    /* report the throughput */
+    printf ("%ld pixels in %ld ms", pixels,
+	    (long) ticks * 1000 / CLOCKS_PER_SEC);
+    if (ticks)
+	printf (", %ld pixels/s",
+		(long) (pixels * (double) CLOCKS_PER_SEC / ticks));
+    printf ("\n");
+}
@@ -0,0 +1,693 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Profile Module.
+ *
+ * Counts the calls made to the drawing functions, and the bytes they
+ * read and write in RAM and in video RAM, for each frame of a program.
+ * Can also record a timeline of the calls in a ring buffer, timed by
+ * the PIT on DOS or by clock () elsewhere, for a trace viewer, and
+ * estimate the processor cycles the drawing would take on the machines
+ * the library is meant for. The counting is compiled in only when the
+ * library is built with CGALIB_PROFILE defined; otherwise all the
+ * counts remain at zero.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __DOS__
+#include <conio.h>
+#include <i86.h>
+#endif
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/** @var names are the names of the functions for prf_dump (). */
+static char *names[PRF_ALL] = {
+    "scr_put",
+    "scr_putpart",
+    "scr_putcompiled",
+    "scr_get",
+    "scr_box",
+    "scr_scroll",
+    "scr_print",
+    "bit_put",
+    "bit_putpart",
+    "bit_putcompiled",
+    "bit_get",
+    "bit_unpack",
+    "bit_pack",
+    "bit_box",
+    "bit_scroll",
+    "bit_print",
+    "fnt_put",
+    "fnt_get"
+};
+
+/** @var modes are the names of the draw modes for prf_dump (). */
+static char *modes[5] = {"pset", "preset", "and", "or", "xor"};
+
+/** @var sum is the sum of counts returned by prf_last or prf_total. */
+static Profile sum;
+
+/** @var MODELS is the number of built-in cost models. */
+#define MODELS 3
+
+/** @var models are the built-in cost models. These are estimates from
+    instruction timings and published wait states, and should be
+    checked against real machines with the timeline where possible. */
+static CostModel models[MODELS] = {
+    {"8088-cga", 4772727L, 250, {9, 16}, {35, 50}},
+    {"286-ega", 8000000L, 80, {3, 10}, {12, 26}},
+    {"8088-hercules", 4772727L, 250, {9, 12}, {35, 42}}
+};
+
+#ifdef CGALIB_PROFILE
+
+/** @var TICKS is the number of timer ticks in a second. */
+#ifdef __DOS__
+#define TICKS 1193182.0
+#else
+#define TICKS ((double) CLOCKS_PER_SEC)
+#endif
+
+/** @var CALIBRATION is the number of events timed for the overhead. */
+#define CALIBRATION 1024
+
+/** @struct event is a call or a frame on the timeline */
+struct event {
+
+    /** @var start is the timer reading at the start */
+    unsigned long start;
+
+    /** @var end is the timer reading at the end */
+    unsigned long end;
+
+    /** @var target is the screen, bitmap or font affected */
+    void *target;
+
+    /** @var read is the bytes read, or the frame number for frames */
+    long read;
+
+    /** @var written is the bytes written */
+    long written;
+
+    /** @var op is the function, or PRF_ALL for a frame */
+    char op;
+
+    /** @var draw is the draw mode */
+    char draw;
+
+    /** @var vram is 1 if the target is the display, 0 if in RAM */
+    char vram;
+};
+
+/** @var current is the counts for the frame in progress. */
+static Profile current[PRF_ALL][5];
+
+/** @var previous is the counts for the last frame marked. */
+static Profile previous[PRF_ALL][5];
+
+/** @var total is the counts for the frames before the current one. */
+static Profile total[PRF_ALL][5];
+
+/** @var frames is the number of frames marked. */
+static long frames;
+
+/** @var trace is the ring buffer of events, or NULL if not recording. */
+static struct event *trace;
+
+/** @var size is the number of events the ring buffer holds. */
+static int size;
+
+/** @var next is the position of the next event in the ring buffer. */
+static int next;
+
+/** @var recorded is the number of events recorded since cleared. */
+static long recorded;
+
+/** @var active is the call in progress, or NULL if there is none. */
+static struct event *active;
+
+/** @var marked is the timer reading when the last frame was marked. */
+static unsigned long marked;
+
+/** @var overhead is the timer ticks taken to record each event. */
+static double overhead;
+
+#endif
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Estimate the cycles taken by the calls to one function in one mode.
+ * @param model is the cost model for the machine.
+ * @param counts is the counts for the function and mode.
+ * @param draw is the draw mode.
+ * @returns the estimated number of cycles.
+ */
+static double estimate (CostModel *model, Profile *counts, int draw)
+{
+    /* local variables */
+    double cycles; /* the cycles to return */
+    int v; /* 0 for RAM, 1 for video RAM */
+
+    /* combining modes read each byte they write; others just copy */
+    cycles = (double) counts->calls * model->call;
+    for (v = 0; v < 2; ++v)
+	if (draw >= DRAW_AND)
+	    cycles += (double) counts->written[v] * model->combine[v];
+	else
+	    cycles += (double) (counts->read[v] + counts->written[v])
+		* model->copy[v];
+    return cycles;
+}
+
+#ifdef CGALIB_PROFILE
+
+/**
+ * Add one set of counts to another.
+ * @param to is the counts to add to.
+ * @param from is the counts to add.
+ */
+static void add (Profile *to, Profile *from)
+{
+    to->calls += from->calls;
+    to->read[0] += from->read[0];
+    to->read[1] += from->read[1];
+    to->written[0] += from->written[0];
+    to->written[1] += from->written[1];
+}
+
+/**
+ * Read the timer.
+ * @returns the timer reading in ticks.
+ */
+static unsigned long now (void)
+{
+#ifdef __DOS__
+
+    /* local variables */
+    unsigned long ticks; /* BIOS tick count */
+    unsigned int count; /* PIT count, which counts down */
+
+    /* read the PIT and the BIOS tick count together */
+    _disable ();
+    outp (0x43, 0x00);
+    count = inp (0x40);
+    count |= inp (0x40) << 8;
+    ticks = *(unsigned long far *) MK_FP (0x40, 0x6c);
+
+    /* if the PIT wrapped before it was read, the tick is pending */
+    outp (0x20, 0x0a);
+    if ((inp (0x20) & 1) && count > 0x8000)
+	++ticks;
+    _enable ();
+    return (ticks << 16) | (unsigned int) (0 - count);
+
+#else
+    return (unsigned long) clock ();
+#endif
+}
+
+/**
+ * Start an event on the timeline.
+ * @param op is the function, or PRF_ALL for a frame.
+ * @param draw is the draw mode.
+ * @param target is the screen, bitmap or font affected.
+ * @returns the event.
+ */
+static struct event *begin (ProfileOp op, DrawMode draw, void *target)
+{
+    /* local variables */
+    struct event *event; /* the event to return */
+
+    /* take the next place in the ring buffer, overwriting the oldest */
+    event = &trace[next];
+    if (++next == size)
+	next = 0;
+    ++recorded;
+
+    /* fill in the event, reading the timer last */
+    event->op = op;
+    event->draw = draw;
+    event->vram = 0;
+    event->target = target;
+    event->read = event->written = 0;
+    event->start = event->end = now ();
+    return event;
+}
+
+/**
+ * Find how long it takes to record an event on the timeline.
+ */
+static void calibrate (void)
+{
+    /* local variables */
+    unsigned long start; /* timer reading at the start */
+    int c; /* event counter */
+
+    /* time a number of events, then forget them */
+    start = now ();
+    for (c = 0; c < CALIBRATION; ++c) {
+	active = begin (PRF_SCR_PUT, DRAW_PSET, NULL);
+	active->end = now ();
+    }
+    overhead = (double) (now () - start) / CALIBRATION;
+    next = 0;
+    recorded = 0;
+    active = NULL;
+}
+
+/**
+ * Convert a timer reading to microseconds from a starting point.
+ * @param ticks is the timer reading.
+ * @param base is the timer reading at the starting point.
+ * @returns the microseconds elapsed.
+ */
+static double micro (unsigned long ticks, unsigned long base)
+{
+    return (long) (ticks - base) * 1e6 / TICKS;
+}
+
+#endif
+
+/**
+ * Add up the counts for some functions and draw modes.
+ * @param last is 1 for the last frame, 0 for the total.
+ * @param op is the function, or PRF_ALL for all functions.
+ * @param draw is the draw mode, or -1 for all draw modes.
+ * @returns the sum.
+ */
+static Profile *add_up (int last, ProfileOp op, int draw)
+{
+#ifdef CGALIB_PROFILE
+
+    /* local variables */
+    int o; /* function counter */
+    int d; /* draw mode counter */
+
+    /* add up the counts that match */
+    memset (&sum, 0, sizeof (Profile));
+    for (o = 0; o < PRF_ALL; ++o)
+	for (d = 0; d < 5; ++d)
+	    if ((op == PRF_ALL || (int) op == o)
+		&& (draw < 0 || draw == d)) {
+		if (last)
+		    add (&sum, &previous[o][d]);
+		else {
+		    add (&sum, &total[o][d]);
+		    add (&sum, &current[o][d]);
+		}
+	    }
+
+#else
+    last = last;
+    op = op;
+    draw = draw;
+#endif
+    return &sum;
+}
+
+/*----------------------------------------------------------------------
+ * Internal Level Functions.
+ */
+
+#ifdef CGALIB_PROFILE
+
+/**
+ * Count a call to a function, and start its event on the timeline.
+ * @param op is the function.
+ * @param draw is the draw mode.
+ * @param target is the screen, bitmap or font drawn on or taken from.
+ */
+void prf_call (ProfileOp op, DrawMode draw, void *target)
+{
+    ++current[op][draw].calls;
+    if (trace)
+	active = begin (op, draw, target);
+}
+
+/**
+ * End the event for a call on the timeline.
+ * @param op is the function.
+ */
+void prf_end (ProfileOp op)
+{
+    if (active && active->op == (char) op) {
+	active->end = now ();
+	active = NULL;
+    }
+}
+
+/**
+ * Count the bytes read and written on the screen or bitmap drawn on.
+ * @param op is the function.
+ * @param draw is the draw mode.
+ * @param vram is 1 if the screen is the display, 0 if in RAM.
+ * @param read is the number of bytes read.
+ * @param written is the number of bytes written.
+ */
+void prf_bytes (ProfileOp op, DrawMode draw, int vram, long read,
+		long written)
+{
+    current[op][draw].read[vram] += read;
+    current[op][draw].written[vram] += written;
+    if (active) {
+	active->vram = vram;
+	active->read += read;
+	active->written += written;
+    }
+}
+
+#endif
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Mark the end of a frame, keeping its counts and starting afresh.
+ */
+void prf_frame (void)
+{
+#ifdef CGALIB_PROFILE
+
+    /* local variables */
+    struct event *event; /* the frame on the timeline */
+    int o; /* function counter */
+    int d; /* draw mode counter */
+
+    /* move the current counts into the last frame and the total */
+    for (o = 0; o < PRF_ALL; ++o)
+	for (d = 0; d < 5; ++d)
+	    add (&total[o][d], &current[o][d]);
+    memcpy (previous, current, sizeof (current));
+    memset (current, 0, sizeof (current));
+    ++frames;
+
+    /* the frame on the timeline runs from the last mark to this one */
+    if (trace) {
+	event = begin (PRF_ALL, DRAW_PSET, NULL);
+	event->start = marked;
+	event->read = frames;
+	marked = event->end;
+    }
+
+#endif
+}
+
+/**
+ * Clear all the counts, and the number of frames.
+ */
+void prf_reset (void)
+{
+#ifdef CGALIB_PROFILE
+    memset (current, 0, sizeof (current));
+    memset (previous, 0, sizeof (previous));
+    memset (total, 0, sizeof (total));
+    frames = 0;
+    next = 0;
+    recorded = 0;
+    active = NULL;
+    if (trace)
+	marked = now ();
+#endif
+}
+
+/**
+ * Return the number of frames marked since the counts were cleared.
+ * @returns the number of frames.
+ */
+long prf_frames (void)
+{
+#ifdef CGALIB_PROFILE
+    return frames;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Return the counts for the last frame marked.
+ * @param op is the function, or PRF_ALL for all functions.
+ * @param draw is the draw mode, or -1 for all draw modes.
+ * @returns the counts, which are overwritten by the next call.
+ */
+Profile *prf_last (ProfileOp op, int draw)
+{
+    return add_up (1, op, draw);
+}
+
+/**
+ * Return the counts since they were cleared, including this frame.
+ * @param op is the function, or PRF_ALL for all functions.
+ * @param draw is the draw mode, or -1 for all draw modes.
+ * @returns the counts, which are overwritten by the next call.
+ */
+Profile *prf_total (ProfileOp op, int draw)
+{
+    return add_up (0, op, draw);
+}
+
+/**
+ * Write a table of the counts to a file.
+ * @param output is the file to write to.
+ * @param last is 1 for the last frame marked, 0 for the total.
+ */
+void prf_dump (FILE *output, int last)
+{
+    /* local variables */
+    Profile *p; /* counts for the current line */
+    int o; /* function counter */
+    int d; /* draw mode counter */
+
+    /* write a line for each function and mode used, then the total */
+    fprintf (output, "%-15s %-6s %7s %9s %9s %9s %9s\n", "Function",
+	     "Mode", "Calls", "RAM rd", "RAM wr", "VRAM rd", "VRAM wr");
+    for (o = 0; o <= PRF_ALL; ++o)
+	for (d = 0; d < 5; ++d) {
+	    if (o == PRF_ALL && d)
+		break;
+	    p = add_up (last, o, (o == PRF_ALL) ? -1 : d);
+	    if (p->calls || o == PRF_ALL)
+		fprintf (output, "%-15s %-6s %7ld %9ld %9ld %9ld %9ld\n",
+			 (o == PRF_ALL) ? "Total" : names[o],
+			 (o == PRF_ALL) ? "" : modes[d], p->calls,
+			 p->read[0], p->written[0], p->read[1],
+			 p->written[1]);
+	}
+}
+
+/**
+ * Start or stop recording a timeline of the drawing functions called.
+ * @param events is the number of calls to keep, or 0 to stop.
+ * @returns 1 if recording has started, 0 if not.
+ */
+int prf_trace (int events)
+{
+#ifdef CGALIB_PROFILE
+
+    /* stop any recording already in progress */
+    if (trace) {
+	mem_account (MEM_OTHER, - (long) size * sizeof (struct event), -1);
+	free (trace);
+	trace = active = NULL;
+    }
+
+    /* make a new ring buffer for the events */
+    if (events <= 0
+	|| (long) events * sizeof (struct event) > (size_t) -1
+	|| ! (trace = malloc (events * sizeof (struct event))))
+	return 0;
+    mem_account (MEM_OTHER, (long) events * sizeof (struct event), 1);
+    size = events;
+
+#ifdef __DOS__
+    /* set the PIT to count down once per tick, not twice */
+    _disable ();
+    outp (0x43, 0x34);
+    outp (0x40, 0x00);
+    outp (0x40, 0x00);
+    _enable ();
+#endif
+
+    /* measure the cost of recording, and start */
+    calibrate ();
+    marked = now ();
+    return 1;
+
+#else
+    events = events;
+    return 0;
+#endif
+}
+
+/**
+ * Return the time taken to record each call on the timeline.
+ * @returns the time in nanoseconds.
+ */
+long prf_overhead (void)
+{
+#ifdef CGALIB_PROFILE
+    return (long) (overhead * 1e9 / TICKS);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Write the timeline recorded as trace event JSON.
+ * @param output is the file to write to.
+ */
+void prf_writetrace (FILE *output)
+{
+#ifdef CGALIB_PROFILE
+
+    /* local variables */
+    struct event *event; /* the event to write */
+    unsigned long base; /* timer reading at the earliest event */
+    int first; /* position of the oldest event kept */
+    int count; /* number of events kept */
+    int c; /* event counter */
+
+    /* find the oldest event kept, and the earliest time */
+    count = (recorded < size) ? (int) recorded : size;
+    first = (recorded < size) ? 0 : next;
+    base = count ? trace[first].start : 0;
+    for (c = 0; c < count; ++c)
+	if ((long) (trace[(first + c) % size].start - base) < 0)
+	    base = trace[(first + c) % size].start;
+
+    /* write the calls on one track and the frames on another */
+    fprintf (output, "{\"traceEvents\":[\n");
+    fprintf (output, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+	     "\"tid\":0,\"args\":{\"name\":\"frames\"}},\n");
+    fprintf (output, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+	     "\"tid\":1,\"args\":{\"name\":\"calls\"}}");
+    for (c = 0; c < count; ++c) {
+	event = &trace[(first + c) % size];
+	if (event->op == PRF_ALL)
+	    fprintf (output, ",\n{\"name\":\"frame %ld\",\"cat\":\"frame\","
+		     "\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%.3f,"
+		     "\"dur\":%.3f}", event->read,
+		     micro (event->start, base),
+		     micro (event->end, event->start));
+	else
+	    fprintf (output, ",\n{\"name\":\"%s\",\"cat\":\"%s\","
+		     "\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,"
+		     "\"dur\":%.3f,\"args\":{\"target\":\"%p\","
+		     "\"memory\":\"%s\",\"read\":%ld,\"written\":%ld}}",
+		     names[(int) event->op], modes[(int) event->draw],
+		     micro (event->start, base),
+		     micro (event->end, event->start), event->target,
+		     event->vram ? "vram" : "ram", event->read,
+		     event->written);
+    }
+
+    /* say how many events were lost, and what recording cost */
+    fprintf (output, "\n],\n\"displayTimeUnit\":\"ms\",\n"
+	     "\"otherData\":{\"recorded\":%ld,\"kept\":%d,"
+	     "\"overhead_ns\":%ld}}\n", recorded, count, prf_overhead ());
+
+#else
+    fprintf (output, "{\"traceEvents\":[]}\n");
+#endif
+}
+
+/**
+ * Find one of the built-in cost models.
+ * @param name is the name of the machine, such as "8088-cga".
+ * @returns the cost model, or NULL if there is none of that name.
+ */
+CostModel *prf_model (char *name)
+{
+    /* local variables */
+    int m; /* model counter */
+
+    /* look for the model by name */
+    for (m = 0; m < MODELS; ++m)
+	if (! strcmp (models[m].name, name))
+	    return &models[m];
+    return NULL;
+}
+
+/**
+ * Estimate the processor cycles taken by some functions.
+ * @param model is the cost model for the machine.
+ * @param op is the function, or PRF_ALL for all functions.
+ * @param draw is the draw mode, or -1 for all draw modes.
+ * @param last is 1 for the last frame marked, 0 for the total.
+ * @returns the estimated number of cycles.
+ */
+double prf_cycles (CostModel *model, ProfileOp op, int draw, int last)
+{
+    /* local variables */
+    double cycles; /* the cycles to return */
+    int o; /* function counter */
+    int d; /* draw mode counter */
+
+    /* each function and mode is costed separately, then added up */
+    cycles = 0;
+    for (o = 0; o < PRF_ALL; ++o)
+	for (d = 0; d < 5; ++d)
+	    if ((op == PRF_ALL || (int) op == o)
+		&& (draw < 0 || draw == d))
+		cycles += estimate (model, add_up (last, o, d), d);
+    return cycles;
+}
+
+/**
+ * Write a table of the estimated cycles and time to a file.
+ * @param output is the file to write to.
+ * @param model is the cost model for the machine.
+ * @param last is 1 for the last frame marked, 0 for the total.
+ */
+void prf_dumpcost (FILE *output, CostModel *model, int last)
+{
+    /* local variables */
+    double cycles; /* cycles for the current line */
+    double total; /* cycles for all the lines */
+    long calls; /* calls for the current line */
+    long marks; /* number of frames marked */
+    int o; /* function counter */
+    int d; /* draw mode counter */
+
+    /* write a line for each function and mode used */
+    fprintf (output, "Estimated for %s at %.2f MHz\n", model->name,
+	     model->hz / 1e6);
+    fprintf (output, "%-15s %-6s %7s %12s %10s\n", "Function", "Mode",
+	     "Calls", "Cycles", "ms");
+    total = 0;
+    for (o = 0; o < PRF_ALL; ++o)
+	for (d = 0; d < 5; ++d)
+	    if ((calls = add_up (last, o, d)->calls)) {
+		cycles = prf_cycles (model, o, d, last);
+		total += cycles;
+		fprintf (output, "%-15s %-6s %7ld %12.0f %10.2f\n",
+			 names[o], modes[d], calls, cycles,
+			 cycles * 1e3 / model->hz);
+	    }
+
+    /* write the total, and the average per frame for the whole run */
+    fprintf (output, "%-15s %-6s %7ld %12.0f %10.2f\n", "Total", "",
+	     add_up (last, PRF_ALL, -1)->calls, total,
+	     total * 1e3 / model->hz);
+    if (! last && (marks = prf_frames ()))
+	fprintf (output, "%-15s %-6s %7ld %12.0f %10.2f\n", "Per frame",
+		 "", add_up (0, PRF_ALL, -1)->calls / marks,
+		 total / marks, total * 1e3 / model->hz / marks);
+}
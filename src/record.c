@@ -0,0 +1,1316 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Record Module.
+ *
+ * Writes every drawing call a program makes on its screens and bitmaps
+ * to a compact log file, and plays the log back on any screen as fast
+ * as possible. Bitmaps, fonts, compiled sprites and clip regions are
+ * stored once each, by a hash of their contents. Recording is compiled
+ * in only when the library is built with CGALIB_RECORD defined; the
+ * playback is always available.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Data Definitions.
+ */
+
+/* the header at the start of a log */
+#define LOG_HEADER "CGA100R"
+
+/* records that store contents by hash */
+#define LOG_BITMAP 'B'
+#define LOG_FONT 'F'
+#define LOG_COMPILED 'C'
+#define LOG_REGION 'R'
+
+/* records that create, change and destroy the screens and bitmaps */
+#define LOG_SCREEN 'S'
+#define LOG_LOAD 'L'
+#define LOG_DESTROY 'D'
+#define LOG_CLIP 'k'
+#define LOG_INK 'i'
+#define LOG_SETFONT 'f'
+#define LOG_SETREGION 'r'
+#define LOG_PALETTE 'p'
+
+/* records for the drawing calls */
+#define LOG_PUT 'P'
+#define LOG_PUTPART 'Q'
+#define LOG_PUTCOMPILED 'K'
+#define LOG_GET 'G'
+#define LOG_BOX 'X'
+#define LOG_SCROLL 'Y'
+#define LOG_PRINT 'T'
+
+/* flag added to the draw mode of a put from a pre-shifted bitmap */
+#define LOG_SHIFTED 0x80
+
+/* records that mark frames and the end of the log */
+#define LOG_FRAME 'N'
+#define LOG_END 'E'
+
+/** @struct content is a bitmap, font, sprite or region in the log */
+struct content {
+
+    /** @var hash is the hash of the contents */
+    unsigned long hash;
+
+    /** @var object is the object made on playback, or NULL */
+    void *object;
+
+    /** @var kind is the type of record the contents came from */
+    int kind;
+};
+
+/** @struct surface is a screen or bitmap in the log */
+struct surface {
+
+    /** @var target is the screen or bitmap, or NULL if unused */
+    void *target;
+
+    /** @var screen is 1 for a screen, 0 for a bitmap */
+    int screen;
+
+    /** @var hash is the hash of a bitmap's pixels when last logged */
+    unsigned long hash;
+
+    /** @var dirty is 1 if the bitmap has been drawn on since */
+    int dirty;
+
+    /** @var replaced is 1 if the pixels have been replaced since */
+    int replaced;
+
+    /** @var synced is 1 if the settings below have been logged */
+    int synced;
+
+    /** @var clipx is the x coordinate of the clipping rectangle */
+    int clipx;
+
+    /** @var clipy is the y coordinate of the clipping rectangle */
+    int clipy;
+
+    /** @var clipw is the width of the clipping rectangle */
+    int clipw;
+
+    /** @var cliph is the height of the clipping rectangle */
+    int cliph;
+
+    /** @var ink is the ink colour */
+    int ink;
+
+    /** @var paper is the paper colour */
+    int paper;
+
+    /** @var font is the hash of the font, or 0 for none */
+    unsigned long font;
+
+    /** @var region is the hash of the clip region, or 0 for none */
+    unsigned long region;
+};
+
+/** @var logfile is the log being recorded, or NULL. */
+static FILE *logfile;
+
+/** @var contents are the contents in the log, in order of hash. */
+static struct content *contents;
+
+/** @var ncontents is the number of contents in the log. */
+static int ncontents;
+
+/** @var surfaces are the screens and bitmaps in the log. */
+static struct surface *surfaces;
+
+/** @var nsurfaces is the number of places in the surfaces list. */
+static int nsurfaces;
+
+/*----------------------------------------------------------------------
+ * Level 2 Functions.
+ */
+
+#ifdef CGALIB_RECORD
+
+/**
+ * Write a word to the log, low byte first.
+ * @param w is the word to write.
+ */
+static void put_word (int w)
+{
+    fputc (w & 0xff, logfile);
+    fputc ((w >> 8) & 0xff, logfile);
+}
+
+/**
+ * Write a long word to the log, low word first.
+ * @param l is the long word to write.
+ */
+static void put_long (unsigned long l)
+{
+    put_word ((int) (l & 0xffff));
+    put_word ((int) ((l >> 16) & 0xffff));
+}
+
+/**
+ * Add a word to a hash.
+ * @param hash is the hash so far.
+ * @param w is the word.
+ * @returns the new hash.
+ */
+static unsigned long hash_word (unsigned long hash, int w)
+{
+    /* local variables */
+    char b[2]; /* the word, low byte first */
+
+    b[0] = w & 0xff;
+    b[1] = (w >> 8) & 0xff;
+    return bit_hashrow (hash, b, 2);
+}
+
+#endif
+
+/**
+ * Read a word from a log.
+ * @param input is the log.
+ * @returns the word, sign extended.
+ */
+static int get_word (FILE *input)
+{
+    /* local variables */
+    long w; /* the word read */
+
+    w = fgetc (input) & 0xff;
+    w |= (long) (fgetc (input) & 0xff) << 8;
+    return (int) ((w & 0x8000) ? w - 0x10000L : w);
+}
+
+/**
+ * Read a long word from a log.
+ * @param input is the log.
+ * @returns the long word.
+ */
+static unsigned long get_long (FILE *input)
+{
+    /* local variables */
+    unsigned long l; /* the long word read */
+
+    l = get_word (input) & 0xffffUL;
+    l |= (get_word (input) & 0xffffUL) << 16;
+    return l;
+}
+
+/**
+ * Look for contents by their hash.
+ * @param hash is the hash.
+ * @param found is set to 1 if found, 0 if not.
+ * @returns the place of the contents, or where they would go.
+ */
+static int find_content (unsigned long hash, int *found)
+{
+    /* local variables */
+    int low; /* first place the contents might be */
+    int high; /* place after the last they might be */
+    int mid; /* place halfway between */
+
+    /* the list is in order of hash, so search it by halves */
+    low = 0;
+    high = ncontents;
+    while (low < high) {
+	mid = low + (high - low) / 2;
+	if (contents[mid].hash < hash)
+	    low = mid + 1;
+	else
+	    high = mid;
+    }
+    *found = low < ncontents && contents[low].hash == hash;
+    return low;
+}
+
+/**
+ * Add contents to the list, in order of hash.
+ * @param hash is the hash.
+ * @param kind is the type of record.
+ * @param object is the object made on playback, or NULL.
+ * @returns 1 if added, 0 if out of memory.
+ */
+static int add_content (unsigned long hash, int kind, void *object)
+{
+    /* local variables */
+    struct content *bigger; /* the list with room for more */
+    int c; /* place for the new contents */
+    int found; /* 1 if the contents are already there */
+
+    /* make room in the list every 64 contents */
+    c = find_content (hash, &found);
+    if (found)
+	return 1;
+    if (! (ncontents % 64)) {
+	if (! (bigger = realloc (contents, (ncontents + 64)
+				 * sizeof (struct content))))
+	    return 0;
+	contents = bigger;
+    }
+
+    /* move the later contents up, and put the new ones in */
+    memmove (&contents[c + 1], &contents[c],
+	     (ncontents - c) * sizeof (struct content));
+    contents[c].hash = hash;
+    contents[c].kind = kind;
+    contents[c].object = object;
+    ++ncontents;
+    return 1;
+}
+
+/**
+ * Destroy an object made on playback.
+ * @param kind is the type of record it was made from.
+ * @param object is the object.
+ */
+static void destroy_object (int kind, void *object)
+{
+    switch (kind) {
+    case LOG_BITMAP:
+	bit_destroy (object);
+	break;
+    case LOG_FONT:
+	fnt_destroy (object);
+	break;
+    case LOG_COMPILED:
+	cpl_destroy (object);
+	break;
+    case LOG_REGION:
+	rgn_destroy (object);
+	break;
+    }
+}
+
+/**
+ * Destroy the contents list and the surfaces list.
+ */
+static void clear_lists (void)
+{
+    if (contents)
+	free (contents);
+    if (surfaces)
+	free (surfaces);
+    contents = NULL;
+    surfaces = NULL;
+    ncontents = nsurfaces = 0;
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+#ifdef CGALIB_RECORD
+
+/**
+ * Log a bitmap's contents, if they are not in the log already.
+ * @param bitmap is the bitmap.
+ * @returns the hash of the contents.
+ */
+static unsigned long log_bitmap (Bitmap *bitmap)
+{
+    /* local variables */
+    unsigned long hash; /* the hash to return */
+    int r; /* row counter */
+    int found; /* 1 if the contents are already logged */
+
+    /* write the record if it's new */
+    hash = bit_hash (bitmap);
+    find_content (hash, &found);
+    if (! found) {
+	fputc (LOG_BITMAP, logfile);
+	put_long (hash);
+	put_word (bitmap->width);
+	put_word (bitmap->height);
+	for (r = 0; r < bitmap->height; ++r)
+	    fwrite (bit_row (bitmap, r), bitmap->width / 4, 1, logfile);
+	add_content (hash, LOG_BITMAP, NULL);
+    }
+    return hash;
+}
+
+/**
+ * Log a font's contents, if they are not in the log already.
+ * @param font is the font, or NULL.
+ * @returns the hash of the contents, or 0 for no font.
+ */
+static unsigned long log_font (Font *font)
+{
+    /* local variables */
+    unsigned long hash; /* the hash to return */
+    int n; /* number of bytes of pixels */
+    int found; /* 1 if the contents are already logged */
+
+    /* work out the hash */
+    if (! font)
+	return 0;
+    n = 8 * (font->last - font->first + 1);
+    hash = hash_word (2166136261UL, font->first);
+    hash = hash_word (hash, font->last);
+    hash = bit_hashrow (hash, font->pixels, n);
+
+    /* write the record if it's new */
+    find_content (hash, &found);
+    if (! found) {
+	fputc (LOG_FONT, logfile);
+	put_long (hash);
+	put_word (font->first);
+	put_word (font->last);
+	fwrite (font->pixels, n, 1, logfile);
+	add_content (hash, LOG_FONT, NULL);
+    }
+    return hash;
+}
+
+/**
+ * Log a compiled sprite, if it is not in the log already.
+ * @param compiled is the compiled sprite.
+ * @returns the hash of the contents.
+ */
+static unsigned long log_compiled (Compiled *compiled)
+{
+    /* local variables */
+    struct compiledrun *run; /* current run */
+    unsigned long hash; /* the hash to return */
+    int c; /* run counter */
+    int found; /* 1 if the contents are already logged */
+
+    /* work out the hash */
+    hash = hash_word (2166136261UL, compiled->width);
+    hash = hash_word (hash, compiled->height);
+    hash = hash_word (hash, compiled->count);
+    for (c = 0, run = compiled->runs; c < compiled->count; ++c, ++run) {
+	hash = hash_word (hash, run->row);
+	hash = hash_word (hash, run->offset);
+	hash = hash_word (hash, run->length);
+	hash = hash_word (hash, run->masked);
+    }
+    hash = bit_hashrow (hash, compiled->data, compiled->size);
+
+    /* write the record if it's new */
+    find_content (hash, &found);
+    if (! found) {
+	fputc (LOG_COMPILED, logfile);
+	put_long (hash);
+	put_word (compiled->width);
+	put_word (compiled->height);
+	put_word (compiled->count);
+	put_word (compiled->size);
+	for (c = 0, run = compiled->runs; c < compiled->count; ++c, ++run) {
+	    put_word (run->row);
+	    put_word (run->offset);
+	    put_word (run->length);
+	    put_word (run->masked);
+	}
+	fwrite (compiled->data, compiled->size, 1, logfile);
+	add_content (hash, LOG_COMPILED, NULL);
+    }
+    return hash;
+}
+
+/**
+ * Log a clip region, if it is not in the log already.
+ * @param region is the clip region, or NULL.
+ * @returns the hash of the contents, or 0 for no region.
+ */
+static unsigned long log_region (ClipRegion *region)
+{
+    /* local variables */
+    struct cliprow *row; /* current row pair */
+    unsigned long hash; /* the hash to return */
+    int r; /* row pair counter */
+    int s; /* span counter */
+    int found; /* 1 if the contents are already logged */
+
+    /* work out the hash */
+    if (! region)
+	return 0;
+    hash = hash_word (2166136261UL, region->width);
+    hash = hash_word (hash, region->height);
+    for (r = 0, row = region->rows; r < (region->height + 1) / 2;
+	 ++r, ++row) {
+	hash = hash_word (hash, row->count);
+	for (s = 0; s < row->count; ++s) {
+	    hash = hash_word (hash, row->spans[s].x);
+	    hash = hash_word (hash, row->spans[s].w);
+	}
+    }
+
+    /* write the record if it's new */
+    find_content (hash, &found);
+    if (! found) {
+	fputc (LOG_REGION, logfile);
+	put_long (hash);
+	put_word (region->width);
+	put_word (region->height);
+	for (r = 0, row = region->rows; r < (region->height + 1) / 2;
+	     ++r, ++row) {
+	    put_word (row->count);
+	    for (s = 0; s < row->count; ++s) {
+		put_word (row->spans[s].x);
+		put_word (row->spans[s].w);
+	    }
+	}
+	add_content (hash, LOG_REGION, NULL);
+    }
+    return hash;
+}
+
+/**
+ * Log a bitmap's pixels as the contents of a surface.
+ * @param id is the surface.
+ * @param bitmap is the bitmap.
+ */
+static void log_load (int id, Bitmap *bitmap)
+{
+    surfaces[id].hash = log_bitmap (bitmap);
+    surfaces[id].dirty = 0;
+    surfaces[id].replaced = 0;
+    surfaces[id].synced = 0;
+    fputc (LOG_LOAD, logfile);
+    put_word (id);
+    put_long (surfaces[id].hash);
+}
+
+/**
+ * Find a screen or bitmap in the log, adding it if it's new.
+ * @param target is the screen or bitmap.
+ * @param screen is 1 for a screen, 0 for a bitmap.
+ * @returns the surface number, or -1 if out of memory.
+ */
+static int find_surface (void *target, int screen)
+{
+    /* local variables */
+    struct surface *bigger; /* the list with room for more */
+    int id; /* the surface number to return */
+    int unused; /* an unused surface number, or -1 */
+
+    /* look for the target, logging any pixels replaced, and noting any
+       unused place */
+    unused = -1;
+    for (id = 0; id < nsurfaces; ++id)
+	if (surfaces[id].target == target) {
+	    if (surfaces[id].replaced)
+		log_load (id, target);
+	    return id;
+	} else if (! surfaces[id].target && unused < 0)
+	    unused = id;
+
+    /* make room for a new surface if there's none unused */
+    if (unused < 0) {
+	if (! (bigger = realloc (surfaces, (nsurfaces + 16)
+				 * sizeof (struct surface))))
+	    return -1;
+	surfaces = bigger;
+	for (id = nsurfaces; id < nsurfaces + 16; ++id)
+	    surfaces[id].target = NULL;
+	unused = nsurfaces;
+	nsurfaces += 16;
+    }
+
+    /* log the new screen, or the new bitmap's contents */
+    id = unused;
+    surfaces[id].target = target;
+    surfaces[id].screen = screen;
+    surfaces[id].synced = 0;
+    surfaces[id].dirty = 0;
+    surfaces[id].replaced = 0;
+    if (screen) {
+	fputc (LOG_SCREEN, logfile);
+	put_word (id);
+	put_word (((Screen *) target)->mode);
+    } else
+	log_load (id, target);
+    return id;
+}
+
+/**
+ * Find a bitmap used as a source, logging its contents if they have
+ * been changed other than by the drawing functions.
+ * @param bitmap is the bitmap.
+ * @returns the surface number, or -1 if out of memory.
+ */
+static int find_source (Bitmap *bitmap)
+{
+    /* local variables */
+    unsigned long hash; /* the hash of the bitmap now */
+    int id; /* the surface number to return */
+
+    /* bitmaps drawn on will be the same on playback */
+    if ((id = find_surface (bitmap, 0)) < 0)
+	return -1;
+    hash = bit_hash (bitmap);
+    if (hash != surfaces[id].hash && ! surfaces[id].dirty)
+	log_load (id, bitmap);
+    surfaces[id].hash = hash;
+    surfaces[id].dirty = 0;
+    return id;
+}
+
+/**
+ * Log any settings of a surface that have changed since last logged.
+ * @param id is the surface.
+ * @param text is 1 if printing, so that the font matters.
+ */
+static void log_settings (int id, int text)
+{
+    /* local variables */
+    struct surface *s; /* the surface */
+    Screen *screen; /* the surface if it's a screen */
+    Bitmap *bitmap; /* the surface if it's a bitmap */
+    int x; /* x coordinate of the clipping rectangle */
+    int y; /* y coordinate of the clipping rectangle */
+    int w; /* width of the clipping rectangle */
+    int h; /* height of the clipping rectangle */
+    int ink; /* ink colour */
+    int paper; /* paper colour */
+    unsigned long font; /* hash of the font */
+    unsigned long region; /* hash of the clip region */
+
+    /* gather the settings */
+    s = &surfaces[id];
+    if (s->screen) {
+	screen = s->target;
+	x = screen->clipx;
+	y = screen->clipy;
+	w = screen->clipw;
+	h = screen->cliph;
+	ink = screen->ink;
+	paper = screen->paper;
+	font = (text || ! s->synced) ? log_font (screen->font) : s->font;
+	region = log_region (screen->region);
+    } else {
+	bitmap = s->target;
+	x = bitmap->clipx;
+	y = bitmap->clipy;
+	w = bitmap->clipw;
+	h = bitmap->cliph;
+	ink = bitmap->ink;
+	paper = bitmap->paper;
+	font = (text || ! s->synced) ? log_font (bitmap->font) : s->font;
+	region = log_region (bitmap->region);
+    }
+
+    /* log those that have changed */
+    if (! s->synced || x != s->clipx || y != s->clipy || w != s->clipw
+	|| h != s->cliph) {
+	fputc (LOG_CLIP, logfile);
+	put_word (id);
+	put_word (s->clipx = x);
+	put_word (s->clipy = y);
+	put_word (s->clipw = w);
+	put_word (s->cliph = h);
+    }
+    if (! s->synced || ink != s->ink || paper != s->paper) {
+	fputc (LOG_INK, logfile);
+	put_word (id);
+	put_word (s->ink = ink);
+	put_word (s->paper = paper);
+    }
+    if (! s->synced || font != s->font) {
+	fputc (LOG_SETFONT, logfile);
+	put_word (id);
+	put_long (s->font = font);
+    }
+    if (! s->synced || region != s->region) {
+	fputc (LOG_SETREGION, logfile);
+	put_word (id);
+	put_long (s->region = region);
+    }
+    s->synced = 1;
+}
+
+#endif
+
+/**
+ * Find the object made on playback from some contents.
+ * @param hash is the hash of the contents, or 0 for none.
+ * @param kind is the type of record expected.
+ * @param object is set to the object, or NULL for none.
+ * @returns 1 if found, 0 if the log is faulty.
+ */
+static int get_object (unsigned long hash, int kind, void **object)
+{
+    /* local variables */
+    int c; /* place of the contents */
+    int found; /* 1 if the contents were found */
+
+    *object = NULL;
+    if (! hash)
+	return 1;
+    c = find_content (hash, &found);
+    if (! found || contents[c].kind != kind)
+	return 0;
+    *object = contents[c].object;
+    return 1;
+}
+
+/**
+ * Read a record of contents from a log and make its object.
+ * @param input is the log.
+ * @param kind is the type of record.
+ * @returns 1 if successful, 0 if not.
+ */
+static int read_content (FILE *input, int kind)
+{
+    /* local variables */
+    unsigned long hash; /* hash of the contents */
+    void *object; /* the object made */
+    Bitmap *bitmap; /* the object if a bitmap */
+    Font *font; /* the object if a font */
+    Compiled *compiled; /* the object if a compiled sprite */
+    ClipRegion *region; /* the object if a clip region */
+    int w; /* width of the object */
+    int h; /* height of the object */
+    int r; /* row or run counter */
+    int s; /* span counter */
+    int n; /* number of spans */
+    int x; /* byte offset of a span */
+    int found; /* 1 if the contents were read before */
+
+    /* read the contents */
+    hash = get_long (input);
+    w = get_word (input);
+    h = get_word (input);
+    object = NULL;
+    switch (kind) {
+    case LOG_BITMAP:
+	if (! (object = bitmap = bit_create (w, h)))
+	    return 0;
+	for (r = 0; r < h; ++r)
+	    fread (bit_row (bitmap, r), w / 4, 1, input);
+	break;
+    case LOG_FONT:
+	if (! (object = font = fnt_create (w, h)))
+	    return 0;
+	fread (font->pixels, 8 * (h - w + 1), 1, input);
+	break;
+    case LOG_COMPILED:
+	if (! (object = compiled = malloc (sizeof (Compiled))))
+	    return 0;
+	compiled->width = w;
+	compiled->height = h;
+	compiled->count = get_word (input);
+	compiled->size = get_word (input);
+	compiled->masked = 0;
+	compiled->runs = malloc ((compiled->count ? compiled->count : 1)
+				 * sizeof (struct compiledrun));
+	compiled->data = malloc (compiled->size ? compiled->size : 1);
+	mem_account (MEM_OTHER, sizeof (Compiled) + compiled->size
+		     + (long) compiled->count * sizeof (struct compiledrun),
+		     1);
+	if (! compiled->runs || ! compiled->data) {
+	    cpl_destroy (compiled);
+	    return 0;
+	}
+	for (r = 0; r < compiled->count; ++r) {
+	    compiled->runs[r].row = get_word (input);
+	    compiled->runs[r].offset = get_word (input);
+	    compiled->runs[r].length = get_word (input);
+	    compiled->runs[r].masked = get_word (input);
+	    if (compiled->runs[r].masked)
+		compiled->masked += compiled->runs[r].length;
+	}
+	fread (compiled->data, compiled->size, 1, input);
+	break;
+    case LOG_REGION:
+	if (! (object = region = rgn_create (w, h)))
+	    return 0;
+	for (r = 0; r < (h + 1) / 2; ++r)
+	    for (n = get_word (input), s = 0; s < n; ++s) {
+		x = get_word (input);
+		rgn_union (region, 4 * x, 2 * r, 4 * get_word (input), 2);
+	    }
+	break;
+    }
+
+    /* keep the object unless it's a duplicate or cut short */
+    find_content (hash, &found);
+    if (feof (input) || found || ! add_content (hash, kind, object)) {
+	destroy_object (kind, object);
+	return found && ! feof (input);
+    }
+    return 1;
+}
+
+/*----------------------------------------------------------------------
+ * Internal Level Functions.
+ */
+
+#ifdef CGALIB_RECORD
+
+/**
+ * Record a call to scr_put or bit_put.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param src is the source bitmap.
+ * @param x is the x coordinate at which the bitmap is to be placed.
+ * @param y is the y coordinate at which the bitmap is to be placed.
+ * @param draw is the draw mode.
+ */
+void rec_put (void *dst, int screen, Bitmap *src, int x, int y,
+	      DrawMode draw)
+{
+    /* local variables */
+    int s; /* source surface */
+    int d; /* destination surface */
+
+    if (! logfile || (s = find_source (src)) < 0
+	|| (d = find_surface (dst, screen)) < 0)
+	return;
+    log_settings (d, 0);
+    fputc (LOG_PUT, logfile);
+    put_word (d);
+    put_word (s);
+    put_word (x);
+    put_word (y);
+    fputc (draw | (src->shifts ? LOG_SHIFTED : 0), logfile);
+    surfaces[d].dirty = 1;
+}
+
+/**
+ * Record a call to scr_putpart or bit_putpart.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param src is the source bitmap.
+ * @param xd is the x coordinate at which the bitmap is to be placed.
+ * @param yd is the y coordinate at which the bitmap is to be placed.
+ * @param xs is the x coordinate of the source to copy from.
+ * @param ys is the y coordinate of the source to copy from.
+ * @param w is the width of the section to copy.
+ * @param h is the height of the section to copy.
+ * @param draw is the draw mode.
+ */
+void rec_putpart (void *dst, int screen, Bitmap *src, int xd, int yd,
+		  int xs, int ys, int w, int h, DrawMode draw)
+{
+    /* local variables */
+    int s; /* source surface */
+    int d; /* destination surface */
+
+    if (! logfile || (s = find_source (src)) < 0
+	|| (d = find_surface (dst, screen)) < 0)
+	return;
+    log_settings (d, 0);
+    fputc (LOG_PUTPART, logfile);
+    put_word (d);
+    put_word (s);
+    put_word (xd);
+    put_word (yd);
+    put_word (xs);
+    put_word (ys);
+    put_word (w);
+    put_word (h);
+    fputc (draw, logfile);
+    surfaces[d].dirty = 1;
+}
+
+/**
+ * Record a call to scr_putcompiled or bit_putcompiled.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param src is the compiled sprite.
+ * @param x is the x coordinate at which the sprite is to be placed.
+ * @param y is the y coordinate at which the sprite is to be placed.
+ */
+void rec_putcompiled (void *dst, int screen, Compiled *src, int x,
+		      int y)
+{
+    /* local variables */
+    unsigned long hash; /* hash of the compiled sprite */
+    int d; /* destination surface */
+
+    if (! logfile || (d = find_surface (dst, screen)) < 0)
+	return;
+    log_settings (d, 0);
+    hash = log_compiled (src);
+    fputc (LOG_PUTCOMPILED, logfile);
+    put_word (d);
+    put_long (hash);
+    put_word (x);
+    put_word (y);
+    surfaces[d].dirty = 1;
+}
+
+/**
+ * Record a call to scr_get or bit_get.
+ * @param src is the screen or bitmap to take the bitmap from.
+ * @param screen is 1 if src is a screen, 0 if a bitmap.
+ * @param dst is the destination bitmap.
+ * @param x is the x coordinate where the desired pattern lies.
+ * @param y is the y coordinate where the desired pattern lies.
+ */
+void rec_get (void *src, int screen, Bitmap *dst, int x, int y)
+{
+    /* local variables */
+    int s; /* source surface */
+    int d; /* destination surface */
+
+    if (! logfile
+	|| (s = screen ? find_surface (src, 1) : find_source (src)) < 0
+	|| (d = find_surface (dst, 0)) < 0)
+	return;
+    fputc (LOG_GET, logfile);
+    put_word (s);
+    put_word (d);
+    put_word (x);
+    put_word (y);
+    surfaces[d].dirty = 1;
+}
+
+/**
+ * Record a call to scr_box or bit_box.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param x is the x coordinate of the top left of the box.
+ * @param y is the y coordinate of the top left of the box.
+ * @param width is the width of the box.
+ * @param height is the height of the box.
+ */
+void rec_box (void *dst, int screen, int x, int y, int width,
+	      int height)
+{
+    /* local variables */
+    int d; /* destination surface */
+
+    if (! logfile || (d = find_surface (dst, screen)) < 0)
+	return;
+    log_settings (d, 0);
+    fputc (LOG_BOX, logfile);
+    put_word (d);
+    put_word (x);
+    put_word (y);
+    put_word (width);
+    put_word (height);
+    surfaces[d].dirty = 1;
+}
+
+/**
+ * Record a call to scr_scroll or bit_scroll.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param x is the x coordinate of the area to scroll.
+ * @param y is the y coordinate of the area to scroll.
+ * @param width is the width of the area to scroll.
+ * @param height is the height of the area to scroll.
+ * @param dx is the distance to move right, or left if negative.
+ * @param dy is the distance to move down, or up if negative.
+ * @param fill is the colour for the exposed area, or -1 to leave it.
+ */
+void rec_scroll (void *dst, int screen, int x, int y, int width,
+		 int height, int dx, int dy, int fill)
+{
+    /* local variables */
+    int d; /* destination surface */
+
+    if (! logfile || (d = find_surface (dst, screen)) < 0)
+	return;
+    log_settings (d, 0);
+    fputc (LOG_SCROLL, logfile);
+    put_word (d);
+    put_word (x);
+    put_word (y);
+    put_word (width);
+    put_word (height);
+    put_word (dx);
+    put_word (dy);
+    put_word (fill);
+    surfaces[d].dirty = 1;
+}
+
+/**
+ * Record a call to scr_print or bit_print.
+ * @param dst is the screen or bitmap to affect.
+ * @param screen is 1 if dst is a screen, 0 if a bitmap.
+ * @param x is the x coordinate where the text should appear.
+ * @param y is the y coordinate where the text should appear.
+ * @param message is the message to print.
+ */
+void rec_print (void *dst, int screen, int x, int y, char *message)
+{
+    /* local variables */
+    int d; /* destination surface */
+    int n; /* length of the message */
+
+    if (! logfile || (d = find_surface (dst, screen)) < 0)
+	return;
+    log_settings (d, 1);
+    n = strlen (message);
+    fputc (LOG_PRINT, logfile);
+    put_word (d);
+    put_word (x);
+    put_word (y);
+    put_word (n);
+    fwrite (message, n, 1, logfile);
+    surfaces[d].dirty = 1;
+}
+
+/**
+ * Record a call to scr_palette.
+ * @param screen is the screen to affect.
+ * @param palette is the palette number.
+ * @param colour is the background colour.
+ */
+void rec_palette (Screen *screen, int palette, int colour)
+{
+    /* local variables */
+    int d; /* destination surface */
+
+    if (! logfile || (d = find_surface (screen, 1)) < 0)
+	return;
+    fputc (LOG_PALETTE, logfile);
+    put_word (d);
+    put_word (palette);
+    put_word (colour);
+}
+
+/**
+ * Record that a bitmap's pixels have been replaced other than by the
+ * drawing functions. The pixels are logged when the bitmap is next
+ * used, so a bitmap filled a few rows at a time is logged only once.
+ * @param bitmap is the bitmap.
+ */
+void rec_load (Bitmap *bitmap)
+{
+    /* local variables */
+    int d; /* surface counter */
+
+    /* a new bitmap has its pixels logged when it's added */
+    if (! logfile)
+	return;
+    for (d = 0; d < nsurfaces; ++d)
+	if (surfaces[d].target == bitmap)
+	    surfaces[d].replaced = 1;
+}
+
+/**
+ * Record that a screen or bitmap has been destroyed.
+ * @param target is the screen or bitmap.
+ */
+void rec_destroy (void *target)
+{
+    /* local variables */
+    int d; /* surface counter */
+
+    if (! logfile || ! target)
+	return;
+    for (d = 0; d < nsurfaces; ++d)
+	if (surfaces[d].target == target) {
+	    fputc (LOG_DESTROY, logfile);
+	    put_word (d);
+	    surfaces[d].target = NULL;
+	}
+}
+
+#endif
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Start recording the drawing done to a log file.
+ * @param output is the file to write the log to, opened in binary.
+ * @returns 1 if recording has started, 0 if not.
+ */
+int rec_start (FILE *output)
+{
+#ifdef CGALIB_RECORD
+    rec_stop ();
+    if (! fwrite (LOG_HEADER, 8, 1, output))
+	return 0;
+    logfile = output;
+    return 1;
+#else
+    output = output;
+    return 0;
+#endif
+}
+
+/**
+ * Mark the end of a frame in the log.
+ */
+void rec_frame (void)
+{
+    if (logfile)
+	fputc (LOG_FRAME, logfile);
+}
+
+/**
+ * Finish the log and stop recording.
+ */
+void rec_stop (void)
+{
+    if (logfile) {
+	fputc (LOG_END, logfile);
+	logfile = NULL;
+	clear_lists ();
+    }
+}
+
+/**
+ * Play back a log, drawing everything drawn on the screen onto one.
+ * @param input is the file to read the log from, opened in binary.
+ * @param screen is the screen to draw on.
+ * @returns the number of drawing calls made, or -1 on error.
+ */
+long rec_replay (FILE *input, Screen *screen)
+{
+    /* local variables */
+    char header[8]; /* the header read from the log */
+    char message[256]; /* a message to print */
+    char *text; /* the message, or a longer one */
+    struct surface *s; /* surface affected */
+    struct surface *bigger; /* the surfaces list with room for more */
+    Bitmap *bitmap; /* the surface if it's a bitmap */
+    Bitmap *src; /* a source bitmap */
+    void *object; /* a font, sprite or region */
+    long calls; /* number of drawing calls made */
+    int kind; /* type of record */
+    int id; /* surface number */
+    int a[8]; /* numbers read from a record */
+    int c; /* counter */
+    int shifted; /* 1 if a bitmap was put from its pre-shifted copies */
+    int ok; /* 1 while the log is sound */
+
+    /* check the header, and stop any recording */
+    if (! fread (header, 8, 1, input) || memcmp (header, LOG_HEADER, 8))
+	return -1;
+    rec_stop ();
+
+    /* read each record until the end */
+    calls = 0;
+    ok = 1;
+    while (ok && (kind = fgetc (input)) != LOG_END) {
+
+	/* contents, frames and the end need no surface */
+	if (kind == LOG_BITMAP || kind == LOG_FONT
+	    || kind == LOG_COMPILED || kind == LOG_REGION) {
+	    ok = read_content (input, kind);
+	    continue;
+	} else if (kind == LOG_FRAME)
+	    continue;
+	else if (kind == EOF) {
+	    ok = 0;
+	    continue;
+	}
+
+	/* make room for the surface the record refers to */
+	if ((id = get_word (input)) < 0) {
+	    ok = 0;
+	    continue;
+	}
+	if (id >= nsurfaces) {
+	    if (! (bigger = realloc (surfaces, (id + 16)
+				     * sizeof (struct surface)))) {
+		ok = 0;
+		continue;
+	    }
+	    surfaces = bigger;
+	    for (c = nsurfaces; c < id + 16; ++c)
+		surfaces[c].target = NULL;
+	    nsurfaces = id + 16;
+	}
+	s = &surfaces[id];
+	bitmap = s->target;
+
+	/* screens and bitmaps are made before they are drawn on */
+	if (kind == LOG_SCREEN) {
+	    get_word (input);
+	    s->target = screen;
+	    s->screen = 1;
+	    continue;
+	} else if (kind == LOG_LOAD) {
+	    ok = get_object (get_long (input), LOG_BITMAP, &object)
+		&& object;
+	    if (ok) {
+		if (bitmap && ! s->screen)
+		    bit_destroy (bitmap);
+		s->target = bit_copy (object);
+		s->screen = 0;
+		ok = s->target != NULL;
+	    }
+	    continue;
+	} else if (! s->target) {
+	    ok = 0;
+	    continue;
+	}
+
+	/* carry out the record on the screen or bitmap */
+	switch (kind) {
+	case LOG_DESTROY:
+	    if (! s->screen)
+		bit_destroy (bitmap);
+	    s->target = NULL;
+	    break;
+	case LOG_CLIP:
+	    for (c = 0; c < 4; ++c)
+		a[c] = get_word (input);
+	    if (s->screen)
+		scr_clip (screen, a[0], a[1], a[2], a[3]);
+	    else
+		bit_clip (bitmap, a[0], a[1], a[2], a[3]);
+	    break;
+	case LOG_INK:
+	    a[0] = get_word (input);
+	    a[1] = get_word (input);
+	    if (s->screen) {
+		scr_ink (screen, a[0]);
+		scr_paper (screen, a[1]);
+	    } else {
+		bit_ink (bitmap, a[0]);
+		bit_paper (bitmap, a[1]);
+	    }
+	    break;
+	case LOG_SETFONT:
+	    if (! (ok = get_object (get_long (input), LOG_FONT, &object)))
+		break;
+	    if (s->screen)
+		scr_font (screen, object);
+	    else
+		bit_font (bitmap, object);
+	    break;
+	case LOG_SETREGION:
+	    if (! (ok = get_object (get_long (input), LOG_REGION, &object)))
+		break;
+	    if (s->screen)
+		scr_region (screen, object);
+	    else
+		bit_region (bitmap, object);
+	    break;
+	case LOG_PALETTE:
+	    a[0] = get_word (input);
+	    a[1] = get_word (input);
+	    if (s->screen)
+		scr_palette (screen, a[0], a[1]);
+	    break;
+	case LOG_PUT:
+	case LOG_PUTPART:
+	    a[0] = get_word (input);
+	    for (c = 1; c < ((kind == LOG_PUT) ? 3 : 7); ++c)
+		a[c] = get_word (input);
+	    a[7] = fgetc (input);
+	    shifted = a[7] >= 0 && (a[7] & LOG_SHIFTED);
+	    if (shifted)
+		a[7] &= ~LOG_SHIFTED;
+	    if (a[0] < 0 || a[0] >= nsurfaces
+		|| ! (src = surfaces[a[0]].target)
+		|| surfaces[a[0]].screen || a[7] < 0 || a[7] > DRAW_XOR) {
+		ok = 0;
+		break;
+	    }
+	    if (shifted && ! src->shifts)
+		bit_preshift (src);
+	    if (kind == LOG_PUT && s->screen)
+		scr_put (screen, src, a[1], a[2], a[7]);
+	    else if (kind == LOG_PUT)
+		bit_put (bitmap, src, a[1], a[2], a[7]);
+	    else if (s->screen)
+		scr_putpart (screen, src, a[1], a[2], a[3], a[4], a[5],
+			     a[6], a[7]);
+	    else
+		bit_putpart (bitmap, src, a[1], a[2], a[3], a[4], a[5],
+			     a[6], a[7]);
+	    ++calls;
+	    break;
+	case LOG_PUTCOMPILED:
+	    ok = get_object (get_long (input), LOG_COMPILED, &object)
+		&& object;
+	    a[0] = get_word (input);
+	    a[1] = get_word (input);
+	    if (ok && s->screen)
+		scr_putcompiled (screen, object, a[0], a[1]);
+	    else if (ok)
+		bit_putcompiled (bitmap, object, a[0], a[1]);
+	    ++calls;
+	    break;
+	case LOG_GET:
+	    for (c = 0; c < 3; ++c)
+		a[c] = get_word (input);
+	    if (a[0] < 0 || a[0] >= nsurfaces
+		|| ! (src = surfaces[a[0]].target)
+		|| surfaces[a[0]].screen) {
+		ok = 0;
+		break;
+	    }
+	    if (s->screen)
+		scr_get (screen, src, a[1], a[2]);
+	    else
+		bit_get (bitmap, src, a[1], a[2]);
+	    ++calls;
+	    break;
+	case LOG_BOX:
+	    for (c = 0; c < 4; ++c)
+		a[c] = get_word (input);
+	    if (s->screen)
+		scr_box (screen, a[0], a[1], a[2], a[3]);
+	    else
+		bit_box (bitmap, a[0], a[1], a[2], a[3]);
+	    ++calls;
+	    break;
+	case LOG_SCROLL:
+	    for (c = 0; c < 7; ++c)
+		a[c] = get_word (input);
+	    if (s->screen)
+		scr_scroll (screen, a[0], a[1], a[2], a[3], a[4], a[5],
+			    a[6]);
+	    else
+		bit_scroll (bitmap, a[0], a[1], a[2], a[3], a[4], a[5],
+			    a[6]);
+	    ++calls;
+	    break;
+	case LOG_PRINT:
+	    for (c = 0; c < 3; ++c)
+		a[c] = get_word (input);
+	    if (a[2] < 0 || ! (text = (a[2] < 256) ? message
+				: malloc (a[2] + 1))) {
+		ok = 0;
+		break;
+	    }
+	    if (a[2] && ! fread (text, a[2], 1, input)) {
+		ok = 0;
+		if (text != message)
+		    free (text);
+		break;
+	    }
+	    text[a[2]] = '\0';
+	    if (s->screen)
+		scr_print (screen, a[0], a[1], text);
+	    else
+		bit_print (bitmap, a[0], a[1], text);
+	    if (text != message)
+		free (text);
+	    ++calls;
+	    break;
+	default:
+	    ok = 0;
+	}
+    }
+
+    /* the screen should no longer refer to fonts and regions */
+    scr_font (screen, NULL);
+    scr_region (screen, NULL);
+
+    /* destroy the bitmaps and contents made */
+    for (id = 0; id < nsurfaces; ++id)
+	if (surfaces[id].target && ! surfaces[id].screen)
+	    bit_destroy (surfaces[id].target);
+    for (c = 0; c < ncontents; ++c)
+	destroy_object (contents[c].kind, contents[c].object);
+    clear_lists ();
+
+    /* return the number of calls, or -1 if the log was faulty */
+    return ok ? calls : -1;
+}
@@ -0,0 +1,302 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Clip Region Module.
+ *
+ * Keeps a list of horizontal spans for each pair of rows, so that
+ * drawing on a bitmap or the screen can be limited to an area that is
+ * not a simple rectangle, such as the visible part of a window.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Add a span to a row, or remove it from the row.
+ * @param row is the row to affect.
+ * @param a is the first byte of the span.
+ * @param e is the byte after the span.
+ * @param add is 1 to add the span, 0 to remove it.
+ * @returns 1 on success, 0 if there was not enough memory.
+ */
+static int update (struct cliprow *row, int a, int e, int add)
+{
+    /* local variables */
+    struct clipspan *spans; /* the new span list */
+    struct clipspan *s; /* the current old span */
+    int count; /* number of new spans */
+    int c; /* old span counter */
+    int done; /* 1 when the added span has been stored */
+
+    /* a new span can add at most one to the count, as can a removed
+       span that splits an existing one */
+    if (! (spans = malloc ((row->count + 1) * sizeof (struct clipspan))))
+	return 0;
+    count = 0;
+    done = ! add;
+
+    /* merge the span with the existing ones */
+    for (c = 0, s = row->spans; c < row->count; ++c, ++s)
+
+	/* spans touching the new span are absorbed into it */
+	if (add) {
+	    if (s->x + s->w < a)
+		spans[count++] = *s;
+	    else if (s->x > e) {
+		if (! done) {
+		    spans[count].x = a;
+		    spans[count++].w = e - a;
+		    done = 1;
+		}
+		spans[count++] = *s;
+	    } else {
+		if (s->x < a)
+		    a = s->x;
+		if (s->x + s->w > e)
+		    e = s->x + s->w;
+	    }
+	}
+
+	/* spans overlapping a removed span keep what lies either side */
+	else {
+	    if (s->x < a) {
+		spans[count].x = s->x;
+		spans[count++].w = (s->x + s->w < a) ? s->w : a - s->x;
+	    }
+	    if (s->x + s->w > e) {
+		spans[count].x = (s->x > e) ? s->x : e;
+		spans[count].w = s->x + s->w - spans[count].x;
+		++count;
+	    }
+	}
+
+    /* a new span to the right of all the others goes on the end */
+    if (! done) {
+	spans[count].x = a;
+	spans[count++].w = e - a;
+    }
+
+    /* replace the old list with the new, counting the spans in use */
+    mem_account (MEM_OTHER,
+		 (long) (count - row->count) * sizeof (struct clipspan), 0);
+    if (row->spans)
+	free (row->spans);
+    row->spans = spans;
+    row->count = count;
+    return 1;
+}
+
+/**
+ * Add a rectangle to a region, or remove it from the region.
+ * @param region is the clip region to affect.
+ * @param x is the x coordinate of the rectangle.
+ * @param y is the y coordinate of the rectangle.
+ * @param width is the width of the rectangle.
+ * @param height is the height of the rectangle.
+ * @param add is 1 to add the rectangle, 0 to remove it.
+ * @returns 1 on success, 0 if there was not enough memory.
+ */
+static int change (ClipRegion *region, int x, int y, int width,
+		   int height, int add)
+{
+    /* local variables */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+    int r; /* row pair counter */
+
+    /* keep the rectangle within the region */
+    xs = ys = 0;
+    if (! bit_cliprect (&x, &y, &xs, &ys, &width, &height,
+			0, 0, region->width, region->height))
+	return 1;
+
+    /* update every row pair the rectangle touches */
+    for (r = y / 2; r <= (y + height - 1) / 2; ++r)
+	if (! update (region->rows + r, x / 4, (x + width) / 4, add))
+	    return 0;
+    return 1;
+}
+
+/*----------------------------------------------------------------------
+ * Internal Level Functions.
+ */
+
+/**
+ * Find the next piece of a row that lies within a clip region.
+ * @param region is the clip region, or NULL for no region.
+ * @param y is the row.
+ * @param b is the byte offset of the start of the row to draw.
+ * @param n is the number of bytes in the row to draw.
+ * @param i points to the span counter, initially 0.
+ * @param a points to where the first byte of the piece is stored.
+ * @param e points to where the byte after the piece is stored.
+ * @returns 1 if a piece was found, 0 if there are no more.
+ */
+int rgn_next (ClipRegion *region, int y, int b, int n, int *i,
+	      int *a, int *e)
+{
+    /* local variables */
+    struct cliprow *row; /* the row pair containing the row */
+    struct clipspan *s; /* the current span */
+
+    /* without a region, the whole row is a single piece */
+    if (! region) {
+	if (*i)
+	    return 0;
+	*i = 1;
+	*a = b;
+	*e = b + n;
+	return n > 0;
+    }
+
+    /* rows outside the region, and empty rows, are not drawn at all */
+    if (y < 0 || y >= region->height || n <= 0)
+	return 0;
+
+    /* find the next span that overlaps the row to draw */
+    row = region->rows + y / 2;
+    for (; *i < row->count; ++*i) {
+	s = row->spans + *i;
+	if (s->x + s->w <= b)
+	    continue;
+	if (s->x >= b + n)
+	    return 0;
+	*a = (s->x > b) ? s->x : b;
+	*e = (s->x + s->w < b + n) ? s->x + s->w : b + n;
+	++*i;
+	return 1;
+    }
+    return 0;
+}
+
+/**
+ * Put one row of bitmap data through a clip region.
+ * @param region is the clip region.
+ * @param y is the destination row.
+ * @param d is the address of the first destination byte.
+ * @param s is the address of the first source byte.
+ * @param b is the byte offset of the first destination byte.
+ * @param n is the number of bytes in the row.
+ * @param left is the mask of pixels covered in the first byte.
+ * @param right is the mask of pixels covered in the last byte.
+ * @param draw is the drawing mode to use.
+ */
+void rgn_putrow (ClipRegion *region, int y, char far *d, char *s,
+		 int b, int n, char left, char right, DrawMode draw)
+{
+    /* local variables */
+    int i; /* span counter */
+    int a; /* first byte of the current piece */
+    int e; /* byte after the current piece */
+
+    /* only the true ends of the row are partly covered */
+    for (i = 0; rgn_next (region, y, b, n, &i, &a, &e); )
+	bit_shiftrow (d + a - b, s + a - b, e - a,
+		      (a == b) ? left : 0xff,
+		      (e == b + n) ? right : 0xff, draw);
+}
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Create an empty clip region.
+ * @param width is the width of the region in pixels.
+ * @param height is the height of the region in pixels.
+ * @returns the new clip region.
+ */
+ClipRegion *rgn_create (int width, int height)
+{
+    /* local variables */
+    ClipRegion *region; /* the region to return */
+    int r; /* row pair counter */
+
+    /* reserve memory for the region and its rows */
+    if (! (region = malloc (sizeof (ClipRegion))))
+	return NULL;
+    if (! (region->rows = malloc
+	   ((height > 0 ? (height + 1) / 2 : 1)
+	    * sizeof (struct cliprow)))) {
+	free (region);
+	return NULL;
+    }
+
+    /* initialise the region with no spans */
+    region->width = width;
+    region->height = height;
+    for (r = 0; r < (height + 1) / 2; ++r) {
+	region->rows[r].count = 0;
+	region->rows[r].spans = NULL;
+    }
+    mem_account (MEM_OTHER, sizeof (ClipRegion)
+		 + (long) (height > 0 ? (height + 1) / 2 : 1)
+		 * sizeof (struct cliprow), 1);
+
+    /* return the region */
+    return region;
+}
+
+/**
+ * Add a rectangle to a clip region.
+ * @param region is the clip region to affect.
+ * @param x is the x coordinate of the rectangle.
+ * @param y is the y coordinate of the rectangle.
+ * @param width is the width of the rectangle.
+ * @param height is the height of the rectangle.
+ * @returns 1 on success, 0 if there was not enough memory.
+ */
+int rgn_union (ClipRegion *region, int x, int y, int width, int height)
+{
+    return change (region, x, y, width, height, 1);
+}
+
+/**
+ * Remove a rectangle from a clip region.
+ * @param region is the clip region to affect.
+ * @param x is the x coordinate of the rectangle.
+ * @param y is the y coordinate of the rectangle.
+ * @param width is the width of the rectangle.
+ * @param height is the height of the rectangle.
+ * @returns 1 on success, 0 if there was not enough memory.
+ */
+int rgn_subtract (ClipRegion *region, int x, int y, int width,
+		  int height)
+{
+    return change (region, x, y, width, height, 0);
+}
+
+/**
+ * Destroy a clip region.
+ * @param region is the clip region to destroy.
+ */
+void rgn_destroy (ClipRegion *region)
+{
+    /* local variables */
+    int r; /* row pair counter */
+
+    if (region) {
+	mem_account (MEM_OTHER, - (long) sizeof (ClipRegion)
+		     - (long) (region->height > 0 ? (region->height + 1) / 2
+			       : 1) * sizeof (struct cliprow), -1);
+	for (r = 0; r < (region->height + 1) / 2; ++r)
+	    if (region->rows[r].spans) {
+		mem_account (MEM_OTHER, - (long) region->rows[r].count
+			     * sizeof (struct clipspan), 0);
+		free (region->rows[r].spans);
+	    }
+	free (region->rows);
+	free (region);
+    }
+}
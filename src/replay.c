@@ -0,0 +1,145 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Replay Program.
+ *
+ * Plays back a log of drawing calls recorded with rec_start (), as
+ * fast as possible, on a screen in memory or on the display. Reports
+ * the calls made per second, and a hash of the screen at the end so
+ * that a recorded session can be used as a regression test.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/*----------------------------------------------------------------------
+ * Required Headers.
+ */
+
+/* standard C headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* project headers */
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * File Level Variables.
+ */
+
+/** @var scr is the screen played back on. */
+static Screen *scr;
+
+/*----------------------------------------------------------------------
+ * Service Routines.
+ */
+
+/**
+ * Error Handler.
+ * @param errorlevel is the error level to return to the OS.
+ * @param message is the message to print.
+ */
+void error_handler (int errorlevel, char *message)
+{
+    if (scr)
+	scr_destroy (scr);
+    puts (message);
+    exit (errorlevel);
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Routines.
+ */
+
+/**
+ * Clear the screen and its settings before playing back.
+ */
+static void clear_screen (void)
+{
+    scr_clip (scr, 0, 0, 320, 200);
+    scr_ink (scr, 0);
+    scr_box (scr, 0, 0, 320, 200);
+    scr_ink (scr, 3);
+    scr_paper (scr, 0);
+}
+
+/*----------------------------------------------------------------------
+ * Top Level Routine.
+ */
+
+/**
+ * Main program.
+ * @param argc is the number of command line arguments.
+ * @param argv is the command line arguments.
+ * No return value as exit () is used to terminate abnormally.
+ */
+void main (int argc, char **argv)
+{
+    /* local variables */
+    FILE *input; /* the log file */
+    char *filename; /* the name of the log file */
+    char *expected; /* the hash expected at the end, or NULL */
+    char hash[9]; /* the hash of the screen at the end */
+    int display; /* 1 to play back on the display */
+    int mode; /* the screen mode */
+    int repeats; /* number of times to play back */
+    int r; /* repeat counter */
+    int c; /* argument counter */
+    long calls; /* calls made in one playback */
+    clock_t start; /* clock reading at the start */
+    double seconds; /* seconds taken */
+
+    /* read the options */
+    filename = expected = NULL;
+    display = 0;
+    mode = 4;
+    repeats = 1;
+    for (c = 1; c < argc; ++c)
+	if (! strcmp (argv[c], "-d"))
+	    display = 1;
+	else if (! strcmp (argv[c], "-h"))
+	    mode = 7;
+	else if (! strcmp (argv[c], "-n") && c + 1 < argc)
+	    repeats = atoi (argv[++c]);
+	else if (! strcmp (argv[c], "-x") && c + 1 < argc)
+	    expected = argv[++c];
+	else if (argv[c][0] != '-' && ! filename)
+	    filename = argv[c];
+	else
+	    repeats = 0;
+    if (! filename || repeats < 1)
+	error_handler (1, "Usage: replay [-d] [-h] [-n repeats] "
+		       "[-x hash] logfile");
+
+    /* open the log and create the screen */
+    if (! (input = fopen (filename, "rb")))
+	error_handler (1, "Cannot open the log");
+    if (! (scr = display ? scr_create (mode) : scr_createmem (mode)))
+	error_handler (1, "Cannot create the screen");
+
+    /* play the log back as many times as asked */
+    start = clock ();
+    for (r = 0; r < repeats; ++r) {
+	clear_screen ();
+	rewind (input);
+	if ((calls = rec_replay (input, scr)) < 0) {
+	    fclose (input);
+	    error_handler (1, "The log is faulty");
+	}
+    }
+    seconds = (double) (clock () - start) / CLOCKS_PER_SEC;
+    fclose (input);
+
+    /* report the results on the text screen */
+    sprintf (hash, "%08lx", scr_hash (scr));
+    scr_destroy (scr);
+    scr = NULL;
+    printf ("%ld calls %d times in %.2f seconds", calls, repeats,
+	    seconds);
+    if (seconds > 0)
+	printf (", %.0f calls per second", calls * repeats / seconds);
+    printf ("\nScreen hash %s\n", hash);
+    if (expected && strcmp (expected, hash))
+	error_handler (2, "The screen is not as expected");
+}
@@ -20,53 +20,39 @@
  * Data Definitions.
  */
 
-/** @var base Base address of graphics output. */
-static char far *base;
+/** @var rowoffset Row offsets for the CGA [0] and Hercules [1] layouts. */
+static unsigned int rowoffset[2][200];
 
-/** @var swidth Physical screen width in bytes. */
-static int swidth;
-
-/** @var interleave Number of rows interleaved. */
-static int interleave;
-
-/* @var ymult Y coordinate multiplier for calculating pixel address. */
-static int ymult;
-
-/* @var ydiv Y coordinate divisor for calculating pixel address. */
-static int ydiv;
+/** @var rows_ready 1 if the row offsets have been worked out. */
+static int rows_ready = 0;
 
 /*----------------------------------------------------------------------
  * Level 2 Functions.
  */
 
 /**
- * Set the screen parameters according to the screen mode. For some
- * reason, if this is done within the set{,_hercules)_mode functions,
- * the values get reset on leaving. So they're here in a separate
- * function, to be called immediately before trying to update the
- * screen if not already set. That ensures they'll be available at the
- * point they are needed.
- * @param screen The screen data.
+ * Work out where each row of the screen lies, for both layouts. This
+ * is done once, when the first screen is created, so that drawing
+ * changes no data shared between screens, and screens in memory can
+ * be drawn on by several threads at once.
  */
-void set_screen_parameters (Screen *screen)
+static void set_screen_parameters (void)
 {
-    /* Hercules screen parameters */
-    if (screen->mode == 7) {
-	base = (char far *) 0xb0000221;
-	swidth = 90;
-	interleave = 4;
-	ymult = 3;
-	ydiv = 2;
-    }
-
-    /* CGA/EGA/VGA screen parameters */
-    else {
-	base = (char far *) 0xb8000000;
-	swidth = 80;
-	interleave = 2;
-	ymult = 1;
-	ydiv = 1;
-    }
+    /* local variables */
+    int h; /* 1 for the Hercules layout, 0 for CGA */
+    int y; /* screen row */
+    int yd; /* physical screen row */
+
+    /* Hercules rows are spread over four banks and 348 lines of 90
+       bytes, CGA rows over two banks of 80 bytes */
+    for (h = 0; h < 2; ++h)
+	for (y = 0; y < 200; ++y) {
+	    yd = h ? y * 3 / 2 : y;
+	    rowoffset[h][y] = h
+		? 0x2000 * (yd % 4) + 90 * (yd / 4)
+		: 0x2000 * (yd % 2) + 80 * (yd / 2);
+	}
+    rows_ready = 1;
 }
 
 /**
@@ -100,6 +86,114 @@ static void set_hercules_mode (void)
  * Level 1 Functions.
  */
 
+/**
+ * Work out the address of a point on the screen. Callers clip their
+ * coordinates first, as there are only rows for the screen itself.
+ * @param screen is the screen.
+ * @param x is the x coordinate.
+ * @param y is the y coordinate, 0..199.
+ * @returns the address of the byte containing the point.
+ */
+static char far *row_address (Screen *screen, int x, int y)
+{
+    return screen->base + rowoffset[screen->mode == 7][y] + x / 4;
+}
+
+/**
+ * Put rows of bitmap data onto the screen.
+ * @param screen is the screen to affect.
+ * @param x is the x coordinate of the destination.
+ * @param y is the y coordinate of the destination.
+ * @param s is the address of the first source byte.
+ * @param stride is the distance between source rows in bytes.
+ * @param n is the number of bytes to put on each row.
+ * @param h is the number of rows.
+ * @param draw is the drawing mode to use.
+ */
+static void put_rows (Screen *screen, int x, int y, char *s,
+		      int stride, int n, int h, DrawMode draw)
+{
+    /* local variables */
+    char far *d; /* address to copy data to */
+    int r; /* row counter */
+
+    /* rows through a clip region are put a piece at a time */
+    if (screen->region) {
+	for (r = 0; r < h; ++r) {
+	    rgn_putrow (screen->region, y + r, row_address (screen, x, y + r),
+			s, x / 4, n, (char) 0xff, (char) 0xff, draw);
+	    s += stride;
+	}
+	return;
+    }
+
+    /* a pair of rows from an even row lies at the same offset in
+       each bank, so only the first needs looking up */
+    r = 0;
+    if (screen->mode != 7 && ! (y & 1))
+	for (; r + 1 < h; r += 2) {
+	    d = row_address (screen, x, y + r);
+	    bit_putrow (d, s, n, draw);
+	    bit_putrow (d + 0x2000, s + stride, n, draw);
+	    s += 2 * stride;
+	}
+
+    /* any other rows are looked up individually */
+    for (; r < h; ++r) {
+	bit_putrow (row_address (screen, x, y + r), s, n, draw);
+	s += stride;
+    }
+}
+
+/**
+ * Put part of a bitmap onto the screen, for scr_putpart or scr_put.
+ * @param op is the function to count the bytes against.
+ * @param dst is the screen to affect.
+ * @param src is the source bitmap.
+ * @param xd is the x coordinate at which the bitmap is to be placed.
+ * @param yd is the y coordinate at which the bitmap is to be placed.
+ * @param xs is the x coordinate of the source to copy from.
+ * @param ys is the y coordinate of the source to copy from.
+ * @param w is the width of the section to copy.
+ * @param h is the height of the section to copy.
+ * @param draw is the draw mode.
+ */
+static void put_part (ProfileOp op, Screen *dst, Bitmap *src, int xd,
+		      int yd, int xs, int ys, int w, int h, DrawMode draw)
+{
+    /* local variables */
+    Bitmap band; /* a page of a paged source bitmap */
+    int first; /* first row of the page */
+    int r; /* rows put from the page */
+
+    /* clip the area to be copied, once for the whole operation */
+    if (! bit_cliprect (&xd, &yd, &xs, &ys, &w, &h, dst->clipx,
+			dst->clipy, dst->clipw, dst->cliph)
+	|| ! bit_cliprect (&xs, &ys, &xd, &yd, &w, &h, 0, 0,
+			   src->width, src->height))
+	return;
+
+    /* a paged bitmap is put a page at a time */
+    if (src->pages) {
+	for (; h > 0; h -= r, yd += r, ys += r) {
+	    first = bit_band (src, ys, &band);
+	    r = band.height - (ys - first);
+	    if (r > h)
+		r = h;
+	    put_part (op, dst, &band, xd, yd, xs, ys - first, w, r, draw);
+	}
+	return;
+    }
+
+    /* copy the pixels */
+    PRF_BYTES (op, draw, ! dst->memory,
+	       (draw >= DRAW_AND) ? (long) (w / 4) * h : 0L,
+	       (long) (w / 4) * h);
+    put_rows (dst, xd, yd,
+	      src->pixels + xs / 4 + src->stride * ys,
+	      src->stride, w / 4, h, draw);
+}
+
 /**
  * Attempt to detect Hercules Graphics Card.
  * @return 1 if Hercules, 0 if not.
@@ -237,6 +331,15 @@ Screen *scr_create (int mode)
     screen->ink = 3;
     screen->paper = 0;
     screen->font = NULL;
+    screen->region = NULL;
+    screen->memory = NULL;
+    screen->base = (screen->mode == 7)
+	? (char far *) 0xb0000221
+	: (char far *) 0xb8000000;
+    scr_clip (screen, 0, 0, 320, 200);
+    mem_account (MEM_SCREEN, sizeof (Screen), 1);
+    if (! rows_ready)
+	set_screen_parameters ();
 
     /* Set the screen mode and palette */
     set_mode (screen);
@@ -247,6 +350,45 @@ Screen *scr_create (int mode)
     return screen;
 }
 
+/**
+ * Create a screen in ordinary memory, laid out like the display.
+ * @param mode is the screen mode: 4, 5 or 6, or 7 for Hercules.
+ * @returns the new screen.
+ */
+Screen *scr_createmem (int mode)
+{
+    /* local variables */
+    Screen *screen; /* the screen to return */
+    unsigned int size; /* size of the screen memory */
+
+    /* reserve memory for the screen and its pixels */
+    if (! (screen = malloc (sizeof (Screen))))
+	return NULL;
+    screen->mode = mode;
+    size = (mode == 7) ? 0x8000 : 0x4000;
+    if (! (screen->memory = malloc (size))) {
+	free (screen);
+	return NULL;
+    }
+    _fmemset (screen->memory, 0, size);
+    screen->base = screen->memory;
+
+    /* initialise the screen parameters, leaving the display alone */
+    screen->palette = (mode == 5) ? 5 : 4;
+    screen->colour = 0;
+    screen->ink = 3;
+    screen->paper = 0;
+    screen->font = NULL;
+    screen->region = NULL;
+    scr_clip (screen, 0, 0, 320, 200);
+    mem_account (MEM_SCREEN, sizeof (Screen) + (long) size, 1);
+    if (! rows_ready)
+	set_screen_parameters ();
+
+    /* return the new screen */
+    return screen;
+}
+
 /**
  * Set the screen palette.
  * @param screen is the screen to affect.
@@ -255,13 +397,16 @@ Screen *scr_create (int mode)
  */
 void scr_palette (Screen *screen, int palette, int colour)
 {
-    /* update the palette and colour in the screen data */
+    /* record the call, and update the palette and colour in the data */
+    REC_PALETTE (screen, palette, colour);
     screen->palette = palette;
     screen->colour = colour;
 
-    /* update the palette and colour on the screen */
-    palette_cga (screen);
-    palette_ega (screen);
+    /* update the palette and colour on the display */
+    if (! screen->memory) {
+	palette_cga (screen);
+	palette_ega (screen);
+    }
 }
 
 /**
@@ -279,60 +424,10 @@ void scr_palette (Screen *screen, int palette, int colour)
 void scr_putpart (Screen *dst, Bitmap *src, int xd, int yd,
 		  int xs, int ys, int w, int h, DrawMode draw)
 {
-    /* local variables */
-    char far *d; /* address to copy data to */
-    char *s; /* address to copy data from */
-    int r; /* row counter */
-    int b; /* byte counter */
-    int ydc; /* destination y coordinate */
-
-    /* dst is not used but here for future proofing */
-    dst = dst; /* shut the compiler up, hopefully */
-
-    /* ensure the screen parameters are set up */
-    if (! ydiv)
-	set_screen_parameters (dst);
-
-    /* copy the pixels */
-    for (r = 0; r < h; ++r)
-
-        /* DRAW_PSET can be copied by a quicker method */
-        if (draw == DRAW_PSET) {
-	    ydc = (yd + r) * ymult / ydiv;
-	    d = xd / 4
-		+ 0x2000 * (ydc % interleave)
-		+ swidth * (ydc / interleave)
-		+ base;
-            s = src->pixels + (xs / 4) + (src->width / 4) * (ys + r);
-            _fmemcpy (d, s, w / 4);
-        }
-        
-	/* the other draw operations need doing byte by byte */
-        else 
-            for (b = 0; b < w / 4; ++b) {
-		ydc = (yd + r) * ymult / ydiv;
-		d = b
-		    + xd / 4
-		    + 0x2000 * (ydc % interleave)
-		    + swidth * (ydc / interleave)
-		    + base;
-                s = b + src->pixels + (xs / 4)
-		    + (src->width / 4) * (ys + r);
-                switch (draw) {
-		case DRAW_PRESET:
-		    *d = ~*s;
-		    break;
-		case DRAW_AND:
-		    *d &= *s;
-		    break;
-		case DRAW_OR:
-		    *d |= *s;
-		    break;
-		case DRAW_XOR:
-		    *d ^= *s;
-		    break;
-                }
-            }
+    PRF_CALL (PRF_SCR_PUTPART, draw, dst);
+    REC_PUTPART (dst, 1, src, xd, yd, xs, ys, w, h, draw);
+    put_part (PRF_SCR_PUTPART, dst, src, xd, yd, xs, ys, w, h, draw);
+    PRF_END (PRF_SCR_PUTPART);
 }
 
 /**
@@ -346,57 +441,119 @@ void scr_putpart (Screen *dst, Bitmap *src, int xd, int yd,
 void scr_put (Screen *dst, Bitmap *src, int x, int y, DrawMode draw)
 {
     /* local variables */
-    char far *d; /* address to copy data to */
     char *s; /* address to copy data from */
     int r; /* row counter */
-    int b; /* byte counter */
-    int yd; /* destination y coordinate */
+    int xd; /* clipped destination x coordinate */
+    int yd; /* clipped destination y coordinate */
+    int xs; /* clipped source x coordinate */
+    int ys; /* clipped source y coordinate */
+    int w; /* clipped width */
+    int h; /* clipped height */
+    int n; /* bytes per row of shifted copy */
+    char left; /* mask for the left edge of a shifted copy */
+    char right; /* mask for the right edge of a shifted copy */
+
+    /* count and record; bitmaps on the byte boundary are put whole */
+    PRF_CALL (PRF_SCR_PUT, draw, dst);
+    REC_PUT (dst, 1, src, x, y, draw);
+    if (! (x & 3) || ! src->shifts) {
+	put_part (PRF_SCR_PUT, dst, src, x, y, 0, 0, src->width,
+		  src->height, draw);
+	PRF_END (PRF_SCR_PUT);
+	return;
+    }
 
-    /* dst is not used but here for future proofing */
-    dst = dst; /* shut the compiler up, hopefully */
+    /* others are put from a shifted copy, a byte wider */
+    n = src->width / 4 + 1;
+    xd = x & ~3;
+    yd = y;
+    xs = ys = 0;
+    w = 4 * n;
+    h = src->height;
+    if (! bit_cliprect (&xd, &yd, &xs, &ys, &w, &h, dst->clipx,
+			dst->clipy, dst->clipw, dst->cliph)) {
+	PRF_END (PRF_SCR_PUT);
+	return;
+    }
 
-    /* ensure the screen parameters are set up */
-    if (! ydiv)
-	set_screen_parameters (dst);
+    /* edges that have been clipped are no longer partial */
+    left = xs ? 0xff : 0xff >> (2 * (x & 3));
+    right = (xs + w < 4 * n) ? 0xff : ~(0xff >> (2 * (x & 3)));
 
     /* copy the pixels */
-    for (r = 0; r < src->height; ++r)
-
-        /* DRAW_PSET can be copied by a quicker method */
-        if (draw == DRAW_PSET) {
-	    yd = (y + r) * ymult / ydiv;
-	    d = x / 4
-		+ 0x2000 * (yd % interleave)
-		+ swidth * (yd / interleave)
-		+ base;
-            s = src->pixels + src->width / 4 * r;
-            _fmemcpy (d, s, src->width / 4);
-        }
-        
-        /* the other draw operations need doing byte by byte */
-        else 
-            for (b = 0; b < src->width / 4; ++b) {
-		yd = (y + r) * ymult / ydiv;
-		d = b + x / 4
-		    + 0x2000 * (yd % interleave)
-		    + swidth * (yd / interleave)
-		    + base;
-                s = b + src->pixels + src->width / 4 * r;
-                switch (draw) {
-                    case DRAW_PRESET:
-                        *d = ~*s;
-                        break;
-                    case DRAW_AND:
-                        *d &= *s;
-                        break;
-                    case DRAW_OR:
-                        *d |= *s;
-                        break;
-                    case DRAW_XOR:
-                        *d ^= *s;
-                        break;
-                }
-            }
+    PRF_BYTES (PRF_SCR_PUT, draw, ! dst->memory,
+	       (draw >= DRAW_AND) ? (long) (w / 4) * h : 0L,
+	       (long) (w / 4) * h);
+    s = src->shifts + (long) ((x & 3) - 1) * n * src->height
+	+ xs / 4 + ys * n;
+    for (r = 0; r < h; ++r) {
+	if (dst->region)
+	    rgn_putrow (dst->region, yd + r, row_address (dst, xd, yd + r),
+			s, xd / 4, w / 4, left, right, draw);
+	else
+	    bit_shiftrow (row_address (dst, xd, yd + r), s, w / 4, left,
+			  right, draw);
+	s += n;
+    }
+    PRF_END (PRF_SCR_PUT);
+}
+
+/**
+ * Put a compiled sprite onto the screen.
+ * @param dst is the screen to affect.
+ * @param src is the compiled sprite.
+ * @param x is the x coordinate at which the sprite is to be placed.
+ * @param y is the y coordinate at which the sprite is to be placed.
+ */
+void scr_putcompiled (Screen *dst, Compiled *src, int x, int y)
+{
+    /* local variables */
+    struct compiledrun *run; /* current run */
+    char *s; /* address to copy data from */
+    int c; /* run counter */
+    int r; /* destination row */
+    int n; /* bytes put from the current run */
+    int xd; /* clipped destination x coordinate */
+    int yd; /* clipped destination y coordinate */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+    int w; /* clipped width */
+    int h; /* clipped height */
+    long read; /* bytes read back from the screen */
+    long written; /* bytes written to the screen */
+
+    /* count and record the call, and clip the sprite's rectangle */
+    PRF_CALL (PRF_SCR_PUTCOMPILED, DRAW_PSET, dst);
+    REC_PUTCOMPILED (dst, 1, src, x, y);
+    xd = x;
+    yd = y;
+    xs = ys = 0;
+    w = src->width;
+    h = src->height;
+    if (! bit_cliprect (&xd, &yd, &xs, &ys, &w, &h, dst->clipx,
+			dst->clipy, dst->clipw, dst->cliph)) {
+	PRF_END (PRF_SCR_PUTCOMPILED);
+	return;
+    }
+
+    /* opaque runs are copied, masked runs combined byte by byte */
+    read = written = 0;
+    s = src->data;
+    for (c = 0, run = src->runs; c < src->count; ++c, ++run) {
+	if ((r = y + run->row) >= yd + h)
+	    break;
+	if (r >= yd) {
+	    n = cpl_putrun (run, row_address (dst, 0, r), s, x / 4, r,
+			    xd / 4, (xd + w) / 4, dst->region);
+	    written += n;
+	    if (run->masked)
+		read += n;
+	}
+	s += run->masked ? 2 * run->length : run->length;
+    }
+    PRF_BYTES (PRF_SCR_PUTCOMPILED, DRAW_PSET, ! dst->memory, read,
+	       written);
+    PRF_END (PRF_SCR_PUTCOMPILED);
 }
 
 /**
@@ -409,28 +566,36 @@ void scr_put (Screen *dst, Bitmap *src, int x, int y, DrawMode draw)
 void scr_get (Screen *src, Bitmap *dst, int x, int y)
 {
     /* local variables */
-    char far *s; /* address to copy data from */
     char *d; /* address to copy data to */
     int r; /* row counter */
-    int ys; /* y source coordinate */
-
-    /* src is here for future proofing */
-    src = src; /* shut the compiler up, hopefully */
-
-    /* ensure the screen parameters are set up */
-    if (! ydiv)
-	set_screen_parameters (src);
+    int xd; /* clipped destination x coordinate */
+    int yd; /* clipped destination y coordinate */
+    int w; /* clipped width */
+    int h; /* clipped height */
+
+    /* count and record the call */
+    PRF_CALL (PRF_SCR_GET, DRAW_PSET, src);
+    REC_GET (src, 1, dst, x, y);
+
+    /* only the part of the area on the screen is copied */
+    xd = yd = 0;
+    w = dst->width;
+    h = dst->height;
+    if (! bit_cliprect (&x, &y, &xd, &yd, &w, &h, 0, 0, 320, 200)
+	|| ! bit_own (dst)) {
+	PRF_END (PRF_SCR_GET);
+	return;
+    }
 
     /* copy the pixels */
-    for (r = 0; r < dst->height; ++r) {
- 	ys = (y + r) * ymult / ydiv;
-	s = x / 4
-	    + 0x2000 * (ys % interleave)
-	    + swidth * (ys / interleave)
-	    + base;
-        d = dst->pixels + dst->width / 4 * r;
-        _fmemcpy (d, s, dst->width / 4);
+    PRF_BYTES (PRF_SCR_GET, DRAW_PSET, ! src->memory,
+	       (long) (w / 4) * h, 0L);
+    d = dst->pixels + xd / 4 + yd * dst->stride;
+    for (r = 0; r < h; ++r) {
+        _fmemcpy (d, row_address (src, x, y + r), w / 4);
+	d += dst->stride;
     }
+    PRF_END (PRF_SCR_GET);
 }
 
 /**
@@ -448,25 +613,112 @@ void scr_box (Screen *screen, int x, int y, int width, int height)
     /* local variables */
     char v; /* value to write to the screen */
     int r; /* row counter */
-    char far *d; /* address to write to */
-    int yd; /* y destination coordinate */
-
-    /* ensure the screen parameters are set up */
-    if (! ydiv)
-	set_screen_parameters (screen);
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+    int i; /* clip region span counter */
+    int a; /* first byte of a piece of a row */
+    int e; /* byte after a piece of a row */
+    char far *d; /* address of the start of the row */
+
+    /* count and record the call */
+    PRF_CALL (PRF_SCR_BOX, DRAW_PSET, screen);
+    REC_BOX (screen, 1, x, y, width, height);
+
+    /* clip the box */
+    xs = ys = 0;
+    if (! bit_cliprect (&x, &y, &xs, &ys, &width, &height, screen->clipx,
+			screen->clipy, screen->clipw, screen->cliph)) {
+	PRF_END (PRF_SCR_BOX);
+	return;
+    }
+    PRF_BYTES (PRF_SCR_BOX, DRAW_PSET, ! screen->memory, 0L,
+	       (long) (width / 4) * height);
 
     /* determine the byte value that will fill the box */
     v = screen->ink * 0x55;
 
-    /* fill each individual row */
+    /* fill each individual row, or the parts in the clip region */
     for (r = 0; r < height; ++r) {
-	yd = (y + r) * ymult / ydiv;
-	d = x / 4
-	    + 0x2000 * (yd % interleave)
-	    + swidth * (yd / interleave)
-	    + base;
-        _fmemset (d, v, width / 4);
+	d = row_address (screen, 0, y + r);
+	for (i = 0; rgn_next (screen->region, y + r, x / 4, width / 4,
+			      &i, &a, &e); )
+	    _fmemset (d + a, v, e - a);
     }
+    PRF_END (PRF_SCR_BOX);
+}
+
+/**
+ * Scroll an area of the screen in place.
+ * @param screen is the screen to affect.
+ * @param x is the x coordinate of the area to scroll.
+ * @param y is the y coordinate of the area to scroll.
+ * @param width is the width of the area to scroll.
+ * @param height is the height of the area to scroll.
+ * @param dx is the distance to move right, or left if negative.
+ * @param dy is the distance to move down, or up if negative.
+ * @param fill is the colour for the exposed area, or -1 to leave it.
+ */
+void scr_scroll (Screen *screen, int x, int y, int width, int height,
+		 int dx, int dy, int fill)
+{
+    /* local variables */
+    char far *d; /* address to move data to */
+    int r; /* row counter */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+    int n; /* bytes moved in each row */
+    int h; /* number of rows moved */
+    int top; /* first row moved, relative to the area */
+    int xd; /* x coordinate data is moved to */
+
+    /* count and record the call */
+    PRF_CALL (PRF_SCR_SCROLL, DRAW_PSET, screen);
+    REC_SCROLL (screen, 1, x, y, width, height, dx, dy, fill);
+
+    /* clip the area */
+    xs = ys = 0;
+    if (! bit_cliprect (&x, &y, &xs, &ys, &width, &height, screen->clipx,
+			screen->clipy, screen->clipw, screen->cliph)) {
+	PRF_END (PRF_SCR_SCROLL);
+	return;
+    }
+
+    /* work out how much of the area is moved */
+    n = width / 4 - ((dx < 0) ? -dx : dx) / 4;
+    h = height - ((dy < 0) ? -dy : dy);
+    if (n < 0 || h < 0)
+	n = h = 0;
+    top = (dy > 0) ? dy : 0;
+    xd = x + ((dx > 0) ? dx : 0);
+    PRF_BYTES (PRF_SCR_SCROLL, DRAW_PSET, ! screen->memory, (long) n * h,
+	       (fill < 0) ? (long) n * h : (long) (width / 4) * height);
+
+    /* move the rows, working from the bottom when moving down; rows
+       lie in different banks, so each is looked up in turn */
+    if (dy > 0)
+	for (r = top + h - 1; r >= top; --r)
+	    _fmemmove (row_address (screen, xd, y + r),
+		       row_address (screen, xd - dx, y + r - dy), n);
+    else
+	for (r = top; r < top + h; ++r)
+	    _fmemmove (row_address (screen, xd, y + r),
+		       row_address (screen, xd - dx, y + r - dy), n);
+
+    /* fill the exposed rows, and the exposed ends of the moved ones */
+    if (fill < 0) {
+	PRF_END (PRF_SCR_SCROLL);
+	return;
+    }
+    for (r = 0; r < height; ++r) {
+	d = row_address (screen, x, y + r);
+	if (r < top || r >= top + h)
+	    _fmemset (d, fill * 0x55, width / 4);
+	else if (dx > 0)
+	    _fmemset (d, fill * 0x55, width / 4 - n);
+	else if (dx < 0)
+	    _fmemset (d + n, fill * 0x55, width / 4 - n);
+    }
+    PRF_END (PRF_SCR_SCROLL);
 }
 
 /**
@@ -482,32 +734,50 @@ void scr_print (Screen *screen, int x, int y, char *message)
     /* local variables */
     int b; /* character pointer */
     int r; /* row of character */
-    int yd; /* destination y coordinate */
     char v; /* value of byte in character */
     char far *d; /* pointer to destination byte on screen */
+    int i; /* clip region span counter */
+    int a; /* first byte of a piece of a row */
+    int e; /* byte after a piece of a row */
+    int xd; /* clipped x coordinate */
+    int yd; /* clipped y coordinate */
+    int xs; /* clipped x coordinate within the text */
+    int ys; /* first row of the characters to print */
+    int w; /* clipped width */
+    int h; /* clipped height */
+
+    /* count and record the call, but only print if a font is selected */
+    PRF_CALL (PRF_SCR_PRINT, DRAW_PSET, screen);
+    REC_PRINT (screen, 1, x, y, message);
+    xd = x;
+    yd = y;
+    xs = ys = 0;
+    w = 4 * (int) strlen (message);
+    h = 8;
+    if (! screen->font
+	|| ! bit_cliprect (&xd, &yd, &xs, &ys, &w, &h, screen->clipx,
+			   screen->clipy, screen->clipw, screen->cliph)) {
+	PRF_END (PRF_SCR_PRINT);
+	return;
+    }
 
-    /* only try to print if a font is selected */
-    if (! screen->font) return;
-
-    /* ensure the screen parameters are set up */
-    if (! ydiv)
-	set_screen_parameters (screen);
-
-    /* print each character */
-    for (b = 0; message[b]; ++b)
-        for (r = 0; r < 8; ++r) {
-	    yd = (y + r) * ymult / ydiv;
-	    d = b + x / 4
-		+ 0x2000 * (yd % interleave)
-		+ swidth * (yd / interleave)
-		+ base;
-            v = screen->font->pixels[r + 8
-                * (message[b] - screen->font->first)];
-            if (screen->ink != 3 || screen->paper != 0)
-                v = (v & 0x55 * screen->ink)
-                    | ((0xff ^ v) & 0x55 * screen->paper);
-            *d = v;
-        }
+    /* print each row of the characters within the clip region */
+    PRF_BYTES (PRF_SCR_PRINT, DRAW_PSET, ! screen->memory, 0L,
+	       (long) (w / 4) * h);
+    for (r = ys; r < ys + h; ++r) {
+	d = row_address (screen, x, y + r);
+	for (i = 0; rgn_next (screen->region, y + r, xd / 4, w / 4,
+			      &i, &a, &e); )
+	    for (b = a - x / 4; b < e - x / 4; ++b) {
+		v = screen->font->pixels[r + 8
+		    * (message[b] - screen->font->first)];
+		if (screen->ink != 3 || screen->paper != 0)
+		    v = (v & 0x55 * screen->ink)
+			| ((0xff ^ v) & 0x55 * screen->paper);
+		d[b] = v;
+	    }
+    }
+    PRF_END (PRF_SCR_PRINT);
 }
 
 /**
@@ -540,13 +810,80 @@ void scr_font (Screen *screen, Font *font)
     screen->font = font;
 }
 
+/**
+ * Set the clipping rectangle for put and box operations.
+ * @param screen is the screen to affect.
+ * @param x is the x coordinate of the clipping rectangle.
+ * @param y is the y coordinate of the clipping rectangle.
+ * @param width is the width of the clipping rectangle.
+ * @param height is the height of the clipping rectangle.
+ */
+void scr_clip (Screen *screen, int x, int y, int width, int height)
+{
+    /* local variables */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+
+    /* keep the rectangle within the screen itself */
+    xs = ys = 0;
+    if (! bit_cliprect (&x, &y, &xs, &ys, &width, &height,
+			0, 0, 320, 200))
+	width = height = 0;
+    screen->clipx = x;
+    screen->clipy = y;
+    screen->clipw = width;
+    screen->cliph = height;
+}
+
+/**
+ * Attach a clip region to the screen.
+ * @param screen is the screen to affect.
+ * @param region is the clip region, or NULL to remove it.
+ */
+void scr_region (Screen *screen, ClipRegion *region)
+{
+    screen->region = region;
+}
+
+/**
+ * Calculate a hash of the screen's pixels.
+ * @param screen is the screen to hash.
+ * @returns the hash, which is the same as that of a 320x200 bitmap
+ * holding the same picture, whatever the screen's layout.
+ */
+unsigned long scr_hash (Screen *screen)
+{
+    /* local variables */
+    static char size[4] = {0x40, 0x01, (char) 0xc8, 0x00}; /* 320x200 */
+    unsigned long hash; /* the hash to return */
+    int r; /* row counter */
+
+    /* hash the size, then the pixels a row at a time */
+    hash = bit_hashrow (2166136261UL, size, 4);
+    for (r = 0; r < 200; ++r)
+	hash = bit_hashrow (hash, row_address (screen, 0, r), 80);
+    return hash;
+}
+
 /**
  * Reset the screen back to text mode which graphic output is finished.
  * @param screen is the screen to affect.
  */
 void scr_destroy (Screen *screen)
 {
-    screen->mode = 3;
-    set_mode (screen);
+    /* record the call; a screen in memory just has its memory freed */
+    REC_DESTROY (screen);
+    if (screen->memory) {
+	mem_account (MEM_SCREEN, - (long) sizeof (Screen)
+		     - ((screen->mode == 7) ? 0x8000L : 0x4000L), -1);
+	free (screen->memory);
+    }
+
+    /* otherwise the display goes back to text mode */
+    else {
+	screen->mode = 3;
+	set_mode (screen);
+	mem_account (MEM_SCREEN, - (long) sizeof (Screen), -1);
+    }
     free (screen);
 }
@@ -0,0 +1,474 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Sprite Module.
+ *
+ * Keeps a layer of sprites on the screen, each with a position, depth
+ * and visibility, saving the background beneath each one as it is
+ * drawn. When the screen is updated, only the sprites that have
+ * changed, and those they overlap, are taken off and drawn again, in
+ * order of depth.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Level 3 Functions.
+ */
+
+/**
+ * Work out the area of the screen a sprite covers where it is now.
+ * @param sprite is the sprite.
+ * @param x is set to the x coordinate of the area.
+ * @param y is set to the y coordinate of the area.
+ * @param w is set to the width of the area.
+ * @param h is set to the height of the area.
+ * @returns 1 if the sprite is to be shown, 0 if not.
+ * The area starts on a byte boundary, and is a byte wider than the
+ * image if a pre-shifted image lies across byte boundaries. It is
+ * clipped to the screen's clipping rectangle.
+ */
+static int area (Sprite *sprite, int *x, int *y, int *w, int *h)
+{
+    /* local variables */
+    Screen *screen; /* the screen the sprite is on */
+    int xs; /* unused source x coordinate */
+    int ys; /* unused source y coordinate */
+
+    /* hidden and destroyed sprites cover nothing */
+    if (! sprite->visible || sprite->dead)
+	return 0;
+
+    /* work out the area and clip it */
+    screen = sprite->layer->screen;
+    *x = sprite->x & ~3;
+    *y = sprite->y;
+    *w = sprite->image->width
+	+ (((sprite->x & 3) && sprite->image->shifts) ? 4 : 0);
+    *h = sprite->image->height;
+    xs = ys = 0;
+    return bit_cliprect (x, y, &xs, &ys, w, h, screen->clipx,
+			 screen->clipy, screen->clipw, screen->cliph);
+}
+
+/**
+ * Check whether two areas overlap.
+ * @param ax is the x coordinate of the first area.
+ * @param ay is the y coordinate of the first area.
+ * @param aw is the width of the first area.
+ * @param ah is the height of the first area.
+ * @param bx is the x coordinate of the second area.
+ * @param by is the y coordinate of the second area.
+ * @param bw is the width of the second area.
+ * @param bh is the height of the second area.
+ * @returns 1 if they overlap, 0 if not.
+ */
+static int overlap (int ax, int ay, int aw, int ah, int bx, int by,
+		    int bw, int bh)
+{
+    return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+/*----------------------------------------------------------------------
+ * Level 2 Functions.
+ */
+
+/**
+ * Check whether a sprite on the screen must be redrawn with another.
+ * @param s is a sprite that is being redrawn.
+ * @param t is a sprite on the screen that has not changed.
+ * @returns 1 if t is above s where s was or will be, 0 if not.
+ */
+static int covers (Sprite *s, Sprite *t)
+{
+    /* local variables */
+    int x, y, w, h; /* the area s is to cover */
+
+    /* t must be above s, as it was drawn or as it is to be drawn */
+    if (! ((s->drawn && t->order > s->order) || t->rank > s->rank))
+	return 0;
+
+    /* t must overlap where s was or where s is to be */
+    if (s->drawn && overlap (s->ux, s->uy, s->uw, s->uh,
+			     t->ux, t->uy, t->uw, t->uh))
+	return 1;
+    return area (s, &x, &y, &w, &h)
+	&& overlap (x, y, w, h, t->ux, t->uy, t->uw, t->uh);
+}
+
+/**
+ * Take a sprite off the screen, putting back the background.
+ * @param sprite is the sprite to take off.
+ */
+static void restore (Sprite *sprite)
+{
+    if (sprite->uw && sprite->uh)
+	scr_putpart (sprite->layer->screen, sprite->under, sprite->ux,
+		     sprite->uy, 0, 0, sprite->uw, sprite->uh, DRAW_PSET);
+    sprite->drawn = 0;
+}
+
+/**
+ * Save the background under a sprite and draw it on the screen.
+ * @param sprite is the sprite to draw.
+ * @returns 1 if successful, 0 if out of memory.
+ */
+static int draw (Sprite *sprite)
+{
+    /* local variables */
+    Screen *screen; /* the screen to draw on */
+    Bitmap *view; /* the part of the saved background in use */
+    int w; /* width needed for the saved background */
+
+    /* work out the area, which might be off the screen */
+    screen = sprite->layer->screen;
+    if (! area (sprite, &sprite->ux, &sprite->uy, &sprite->uw,
+		&sprite->uh))
+	sprite->uw = sprite->uh = 0;
+
+    /* make room for the background if the image has grown */
+    w = sprite->image->width + (sprite->image->shifts ? 4 : 0);
+    if (sprite->under && (sprite->under->width < w
+			  || sprite->under->height
+			  < sprite->image->height)) {
+	bit_destroy (sprite->under);
+	sprite->under = NULL;
+    }
+    if (! sprite->under
+	&& ! (sprite->under = bit_create (w, sprite->image->height)))
+	return 0;
+
+    /* save the background, through a view if it is clipped */
+    if (sprite->uw == sprite->under->width
+	&& sprite->uh == sprite->under->height)
+	scr_get (screen, sprite->under, sprite->ux, sprite->uy);
+    else if (sprite->uw && sprite->uh) {
+	if (! (view = bit_view (sprite->under, 0, 0, sprite->uw,
+				sprite->uh)))
+	    return 0;
+	scr_get (screen, view, sprite->ux, sprite->uy);
+	bit_destroy (view);
+    }
+
+    /* draw the sprite, through its mask if it has one */
+    if (sprite->mask) {
+	scr_put (screen, sprite->mask, sprite->x, sprite->y, DRAW_AND);
+	scr_put (screen, sprite->image, sprite->x, sprite->y, DRAW_OR);
+    } else
+	scr_put (screen, sprite->image, sprite->x, sprite->y, DRAW_PSET);
+    sprite->drawn = 1;
+    return 1;
+}
+
+/**
+ * Take a sprite out of its layer's list.
+ * @param sprite is the sprite to take out.
+ */
+static void detach (Sprite *sprite)
+{
+    /* local variables */
+    Sprite **link; /* the link to the sprite in the list */
+
+    for (link = &sprite->layer->first; *link != sprite;
+	 link = &(*link)->next);
+    *link = sprite->next;
+}
+
+/**
+ * Put a sprite into its layer's list, above others of the same depth.
+ * @param sprite is the sprite to put in.
+ */
+static void attach (Sprite *sprite)
+{
+    /* local variables */
+    Sprite **link; /* the link to put the sprite at */
+
+    for (link = &sprite->layer->first; *link && (*link)->z <= sprite->z;
+	 link = &(*link)->next);
+    sprite->next = *link;
+    *link = sprite;
+}
+
+/**
+ * Free a sprite and its saved background.
+ * @param sprite is the sprite to free.
+ */
+static void free_sprite (Sprite *sprite)
+{
+    if (sprite->under)
+	bit_destroy (sprite->under);
+    mem_account (MEM_OTHER, - (long) sizeof (Sprite), -1);
+    free (sprite);
+}
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Take sprites off the screen, from the top down as they were drawn.
+ * @param layer is the layer whose sprites are taken off.
+ * @param all is 1 for all sprites, 0 for those marked to redraw.
+ */
+static void take_off (SpriteLayer *layer, int all)
+{
+    /* local variables */
+    Sprite *s; /* sprite being restored */
+    int o; /* the order of the sprite to restore next */
+
+    for (o = 0, s = layer->first; s; s = s->next)
+	if (s->drawn && s->order >= o)
+	    o = s->order + 1;
+    while (o--)
+	for (s = layer->first; s; s = s->next)
+	    if (s->drawn && s->order == o && (all || s->redraw))
+		restore (s);
+}
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Create a sprite layer on a screen.
+ * @param screen is the screen to draw the sprites on.
+ * @returns the new sprite layer.
+ */
+SpriteLayer *spr_createlayer (Screen *screen)
+{
+    /* local variables */
+    SpriteLayer *layer; /* the layer to return */
+
+    /* reserve memory */
+    if (! (layer = malloc (sizeof (SpriteLayer))))
+	return NULL;
+    mem_account (MEM_OTHER, sizeof (SpriteLayer), 1);
+
+    /* initialise the layer with no sprites */
+    layer->screen = screen;
+    layer->first = NULL;
+    return layer;
+}
+
+/**
+ * Create a sprite in a layer. It is not drawn until spr_update ().
+ * @param layer is the layer to add the sprite to.
+ * @param image is the bitmap to draw.
+ * @param mask is the mask to put with DRAW_AND first, or NULL.
+ * @param z is the depth; higher numbers are drawn over lower.
+ * @returns the new sprite.
+ */
+Sprite *spr_create (SpriteLayer *layer, Bitmap *image, Bitmap *mask,
+		    int z)
+{
+    /* local variables */
+    Sprite *sprite; /* the sprite to return */
+
+    /* reserve memory */
+    if (! (sprite = malloc (sizeof (Sprite))))
+	return NULL;
+    mem_account (MEM_OTHER, sizeof (Sprite), 1);
+
+    /* initialise the sprite, visible at the top left of the screen */
+    sprite->layer = layer;
+    sprite->image = image;
+    sprite->mask = mask;
+    sprite->x = sprite->y = 0;
+    sprite->z = z;
+    sprite->visible = 1;
+    sprite->changed = 1;
+    sprite->dead = 0;
+    sprite->drawn = 0;
+    sprite->order = sprite->rank = 0;
+    sprite->redraw = 0;
+    sprite->under = NULL;
+    sprite->ux = sprite->uy = sprite->uw = sprite->uh = 0;
+    attach (sprite);
+    return sprite;
+}
+
+/**
+ * Move a sprite.
+ * @param sprite is the sprite to move.
+ * @param x is the new x coordinate.
+ * @param y is the new y coordinate.
+ */
+void spr_move (Sprite *sprite, int x, int y)
+{
+    if (x != sprite->x || y != sprite->y) {
+	sprite->x = x;
+	sprite->y = y;
+	sprite->changed = 1;
+    }
+}
+
+/**
+ * Change a sprite's image.
+ * @param sprite is the sprite to change.
+ * @param image is the new bitmap to draw.
+ * @param mask is the new mask, or NULL.
+ */
+void spr_image (Sprite *sprite, Bitmap *image, Bitmap *mask)
+{
+    sprite->image = image;
+    sprite->mask = mask;
+    sprite->changed = 1;
+}
+
+/**
+ * Change a sprite's depth.
+ * @param sprite is the sprite to change.
+ * @param z is the new depth.
+ */
+void spr_depth (Sprite *sprite, int z)
+{
+    if (z != sprite->z) {
+	detach (sprite);
+	sprite->z = z;
+	attach (sprite);
+	sprite->changed = 1;
+    }
+}
+
+/**
+ * Show or hide a sprite.
+ * @param sprite is the sprite to change.
+ * @param visible is 1 to show the sprite, 0 to hide it.
+ */
+void spr_show (Sprite *sprite, int visible)
+{
+    if (visible != sprite->visible) {
+	sprite->visible = visible;
+	sprite->changed = 1;
+    }
+}
+
+/**
+ * Bring the screen up to date with the changes to a layer's sprites.
+ * @param layer is the layer to update.
+ * @returns the number of sprites redrawn, or -1 if out of memory.
+ */
+int spr_update (SpriteLayer *layer)
+{
+    /* local variables */
+    Sprite *s; /* sprite being redrawn */
+    Sprite *t; /* sprite that might need redrawing with it */
+    Sprite *dead; /* a sprite that might be dead */
+    int more; /* 1 if more sprites were found to redraw */
+    int o; /* order counter */
+    int count; /* number of sprites redrawn */
+
+    /* number the sprites in the order they are to be drawn, and mark
+       those that have changed */
+    o = 0;
+    for (s = layer->first; s; s = s->next) {
+	s->rank = o++;
+	s->redraw = s->changed;
+    }
+
+    /* a sprite on the screen that lies above one being redrawn, and
+       overlaps it, has to be redrawn too */
+    do {
+	more = 0;
+	for (s = layer->first; s; s = s->next)
+	    if (s->redraw)
+		for (t = layer->first; t; t = t->next)
+		    if (! t->redraw && t->drawn && covers (s, t))
+			t->redraw = more = 1;
+    } while (more);
+
+    /* put back the backgrounds, and free the dead sprites */
+    take_off (layer, 0);
+    s = layer->first;
+    while (s) {
+	dead = s;
+	s = s->next;
+	if (dead->dead) {
+	    detach (dead);
+	    free_sprite (dead);
+	}
+    }
+
+    /* draw the sprites again, from the bottom up */
+    count = 0;
+    for (s = layer->first; s; s = s->next)
+	if (s->redraw && s->visible) {
+	    if (! draw (s))
+		count = -1;
+	    else {
+		s->changed = 0;
+		if (count >= 0)
+		    ++count;
+	    }
+	} else if (s->redraw)
+	    s->changed = 0;
+
+    /* the sprites on the screen are now in the order of the list */
+    for (o = 0, s = layer->first; s; s = s->next)
+	if (s->drawn)
+	    s->order = o++;
+    return count;
+}
+
+/**
+ * Take all of a layer's sprites off the screen, so that the
+ * background can be drawn on. They are redrawn by spr_update ().
+ * @param layer is the layer to erase.
+ */
+void spr_erase (SpriteLayer *layer)
+{
+    /* local variables */
+    Sprite *s; /* sprite to be drawn again */
+
+    /* put back the backgrounds, and mark every sprite to be redrawn */
+    take_off (layer, 1);
+    for (s = layer->first; s; s = s->next)
+	s->changed = 1;
+}
+
+/**
+ * Destroy a sprite. It is taken off the screen by spr_update ().
+ * @param sprite is the sprite to destroy.
+ */
+void spr_destroy (Sprite *sprite)
+{
+    if (! sprite)
+	return;
+    else if (sprite->drawn) {
+	sprite->dead = 1;
+	sprite->changed = 1;
+    } else {
+	detach (sprite);
+	free_sprite (sprite);
+    }
+}
+
+/**
+ * Destroy a sprite layer, taking its sprites off the screen and
+ * destroying them.
+ * @param layer is the layer to destroy.
+ */
+void spr_destroylayer (SpriteLayer *layer)
+{
+    /* local variables */
+    Sprite *next; /* the next sprite to destroy */
+
+    if (layer) {
+	spr_erase (layer);
+	while (layer->first) {
+	    next = layer->first->next;
+	    free_sprite (layer->first);
+	    layer->first = next;
+	}
+	mem_account (MEM_OTHER, - (long) sizeof (SpriteLayer), -1);
+	free (layer);
+    }
+}
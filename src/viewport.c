@@ -0,0 +1,172 @@
+/*======================================================================
+ * CGALib - Watcom C Version.
+ * Viewport Module.
+ *
+ * Shows part of a world bitmap in a window on the screen. When the view
+ * moves, what is already on the screen is scrolled in place, and only
+ * the newly exposed strips are put from the world bitmap.
+ *
+ * Released as Public Domain by Damian Gareth Walker, 2020.
+ * Created 18-Oct-2026.
+ */
+
+/* define CGALIB macro for access to internal structures */
+#define __CGALIB__
+
+/* included headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include "cgalib.h"
+
+/*----------------------------------------------------------------------
+ * Level 1 Functions.
+ */
+
+/**
+ * Keep a coordinate of the view within the world.
+ * @param w is the coordinate.
+ * @param size is the size of the window.
+ * @param limit is the size of the world.
+ * @returns the coordinate, moved into the world if necessary.
+ */
+static int keep (int w, int size, int limit)
+{
+    if (w > limit - size)
+	w = limit - size;
+    if (w < 0)
+	w = 0;
+    return w;
+}
+
+/*----------------------------------------------------------------------
+ * Public Level Functions.
+ */
+
+/**
+ * Create a viewport onto a world bitmap.
+ * @param screen is the screen to show the world on.
+ * @param world is the world bitmap.
+ * @param x is the x coordinate of the window on the screen.
+ * @param y is the y coordinate of the window on the screen.
+ * @param width is the width of the window.
+ * @param height is the height of the window.
+ * @returns the new viewport.
+ */
+Viewport *vpt_create (Screen *screen, Bitmap *world, int x, int y,
+		      int width, int height)
+{
+    /* local variables */
+    Viewport *viewport; /* the viewport to return */
+
+    /* reserve memory */
+    if (! (viewport = malloc (sizeof (Viewport))))
+	return NULL;
+    mem_account (MEM_OTHER, sizeof (Viewport), 1);
+
+    /* initialise the viewport, looking at the top left of the world */
+    viewport->screen = screen;
+    viewport->world = world;
+    viewport->x = x;
+    viewport->y = y;
+    viewport->width = (width < world->width) ? width : world->width;
+    viewport->height = (height < world->height) ? height : world->height;
+    viewport->wx = 0;
+    viewport->wy = 0;
+
+    /* return the viewport */
+    return viewport;
+}
+
+/**
+ * Redraw the whole window from the world bitmap.
+ * @param viewport is the viewport to redraw.
+ */
+void vpt_draw (Viewport *viewport)
+{
+    scr_putpart (viewport->screen, viewport->world, viewport->x,
+		 viewport->y, viewport->wx, viewport->wy, viewport->width,
+		 viewport->height, DRAW_PSET);
+}
+
+/**
+ * Move the view to a new position in the world.
+ * @param viewport is the viewport to affect.
+ * @param wx is the x coordinate of the new view of the world.
+ * @param wy is the y coordinate of the new view of the world.
+ */
+void vpt_moveto (Viewport *viewport, int wx, int wy)
+{
+    /* local variables */
+    int dx; /* horizontal distance moved */
+    int dy; /* vertical distance moved */
+    int sy; /* first row not in the exposed rows, in the window */
+    int sh; /* number of rows not in the exposed rows */
+
+    /* work out how far the view is actually moving */
+    wx = keep (wx, viewport->width, viewport->world->width);
+    wy = keep (wy, viewport->height, viewport->world->height);
+    dx = wx - viewport->wx;
+    dy = wy - viewport->wy;
+    viewport->wx = wx;
+    viewport->wy = wy;
+    if (! dx && ! dy)
+	return;
+
+    /* if nothing on the screen can be kept, redraw it all */
+    if (dx <= -viewport->width || dx >= viewport->width
+	|| dy <= -viewport->height || dy >= viewport->height) {
+	vpt_draw (viewport);
+	return;
+    }
+
+    /* scroll what is kept, leaving the exposed strips to be put */
+    scr_scroll (viewport->screen, viewport->x, viewport->y,
+		viewport->width, viewport->height, -dx, -dy, -1);
+
+    /* put the exposed rows across the full width */
+    sy = 0;
+    sh = viewport->height;
+    if (dy > 0) {
+	sh -= dy;
+	scr_putpart (viewport->screen, viewport->world, viewport->x,
+		     viewport->y + sh, wx, wy + sh, viewport->width, dy,
+		     DRAW_PSET);
+    } else if (dy < 0) {
+	sy = -dy;
+	sh += dy;
+	scr_putpart (viewport->screen, viewport->world, viewport->x,
+		     viewport->y, wx, wy, viewport->width, -dy, DRAW_PSET);
+    }
+
+    /* put the exposed columns alongside the rows that were kept */
+    if (dx > 0)
+	scr_putpart (viewport->screen, viewport->world,
+		     viewport->x + viewport->width - dx, viewport->y + sy,
+		     wx + viewport->width - dx, wy + sy, dx, sh, DRAW_PSET);
+    else if (dx < 0)
+	scr_putpart (viewport->screen, viewport->world, viewport->x,
+		     viewport->y + sy, wx, wy + sy, -dx, sh, DRAW_PSET);
+}
+
+/**
+ * Move the view by a distance across the world.
+ * @param viewport is the viewport to affect.
+ * @param dx is the distance to move right, or left if negative.
+ * @param dy is the distance to move down, or up if negative.
+ */
+void vpt_pan (Viewport *viewport, int dx, int dy)
+{
+    vpt_moveto (viewport, viewport->wx + dx, viewport->wy + dy);
+}
+
+/**
+ * Destroy a viewport.
+ * @param viewport is the viewport to destroy.
+ */
+void vpt_destroy (Viewport *viewport)
+{
+    if (viewport) {
+	mem_account (MEM_OTHER, - (long) sizeof (Viewport), -1);
+	free (viewport);
+    }
+}